@@ -3,25 +3,43 @@
 #include <sstream>
 #include <unordered_map>
 #include <unordered_set>
+#include <set>
+#include <map>
 #include <memory>
 #include <ctime>
 #include <iomanip>
 #include <fstream>
 #include <queue>
+#include <deque>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <shared_mutex>
 #include <condition_variable>
 #include <vector>
 #include <chrono>
 #include <random>
 #include <algorithm>
 #include <regex>
+#include <limits>
+#include <filesystem>
+#include <cstring>
+#include <cmath>
 
 using namespace std;
 
-std::mutex memMutex;
+// Lock hierarchy for the memory subsystem:
+//   Process::ptMutex  ->  replMutex  ->  try_lock of another Process::ptMutex
+// A resident-page hit takes only the owning process' ptMutex, under every
+// replacement policy. replMutex guards the replacement list, the free-frame
+// allocator and frame ownership changes.
+std::mutex replMutex;
 
-static constexpr char BACKING_FILENAME[] = "csopesy-backing-store.txt";
+static constexpr char BACKING_FILENAME[] = "csopesy-backing-store.txt";       // text dump
+static constexpr char BACKING_STORE_BIN[] = "csopesy-backing-store.bin";      // page slots
+
+// Bytes [0, 64) of every process hold its symbol table (32 uint16 variables)
+static constexpr uint64_t SYMBOL_TABLE_BYTES = 64;
 
 // clamp function
 uint8_t clampCPUs(int value) {
@@ -63,15 +81,28 @@ struct SystemConfig {
     uint64_t memPerFrame = 0;
     uint64_t minMemPerProc = 0;
     uint64_t maxMemPerProc = 0;
+    string pageReplacement = "fifo";     // Optional: fifo, lru, clock or second-chance
+    uint64_t logCapacity = 1000;         // Optional: log entries kept in memory per process
+    bool logSpill = false;               // Optional: spill older log entries to disk
+    uint64_t seed = 0;                   // Optional: RNG seed, 0 = pick one at random
+    uint64_t mlfqLevels = 3;             // Optional: MLFQ priority levels
+    uint64_t mlfqBoostMs = 1000;         // Optional: MLFQ priority boost period, 0 = never
+    uint64_t agingMs = 10;               // Optional: sjf/srtf aging, ms of age worth one instruction
+    uint64_t migrationThreshold = 1;     // Optional: min victim backlog before stealing a warm process
+    uint64_t migrationPenalty = 0;       // Optional: ms (cycles) charged when a process changes core
+    uint64_t utilSampleMs = 1000;        // Optional: per-core utilization sample period
+    uint64_t utilHistory = 60;           // Optional: utilization samples kept per core
+    uint64_t batchSize = 1;              // Optional: processes created per batch arrival
+    string arrivalDist = "fixed";        // Optional: fixed, poisson or bursty arrival gaps
 };
 
-atomic<uint64_t> totalCpuTicks = 0;
-atomic<uint64_t> activeCpuTicks = 0;
-atomic<uint64_t> idleCpuTicks = 0;
-
 atomic<uint64_t> pageInCount = 0;
 atomic<uint64_t> pageOutCount = 0;
 
+// --virtual-time: cores, batch creation and SLEEP are driven by a simulated
+// cycle clock (1 cycle = 1 ms) advanced by the `run` command, not wall time
+bool virtualTimeMode = false;
+
 
 // Declare the global instance
 SystemConfig GLOBAL_CONFIG;
@@ -97,8 +128,8 @@ bool loadSystemConfig(const string& filename = "config.txt") {
         else if (key == "scheduler") {
             string value;
             file >> value;
-            if (value != "fcfs" && value != "rr") {
-                cerr << "Invalid scheduler. Must be 'fcfs' or 'rr'." << endl;
+            if (value != "fcfs" && value != "rr" && value != "mlfq" && value != "sjf" && value != "srtf") {
+                cerr << "Invalid scheduler. Must be 'fcfs', 'rr', 'mlfq', 'sjf' or 'srtf'." << endl;
                 return false;
             }
             GLOBAL_CONFIG.scheduler = value;
@@ -148,6 +179,119 @@ bool loadSystemConfig(const string& filename = "config.txt") {
             file >> value;
             GLOBAL_CONFIG.maxMemPerProc = clampMemPow2(value);
         }
+        else if (key == "page-replacement") {
+            string value;
+            file >> value;
+            if (value != "fifo" && value != "lru" && value != "clock" && value != "second-chance") {
+                cerr << "Invalid page-replacement. Must be 'fifo', 'lru', 'clock' or 'second-chance'." << endl;
+                return false;
+            }
+            GLOBAL_CONFIG.pageReplacement = value;
+        }
+        else if (key == "seed") {
+            uint64_t value;
+            file >> value;
+            GLOBAL_CONFIG.seed = value;
+        }
+        else if (key == "mlfq-levels") {
+            int64_t value;
+            file >> value;
+            if (value < 1 || value > 16) {
+                cerr << "Invalid mlfq-levels. Must be 1-16." << endl;
+                return false;
+            }
+            GLOBAL_CONFIG.mlfqLevels = static_cast<uint64_t>(value);
+        }
+        else if (key == "mlfq-boost-ms") {
+            int64_t value;
+            file >> value;
+            if (value < 0 || value > 4294967296LL) {
+                cerr << "Invalid mlfq-boost-ms. Must be 0-4294967296 (0 = never boost)." << endl;
+                return false;
+            }
+            GLOBAL_CONFIG.mlfqBoostMs = static_cast<uint64_t>(value);
+        }
+        else if (key == "aging-ms") {
+            int64_t value;
+            file >> value;
+            if (value < 0 || value > 1000) {
+                cerr << "Invalid aging-ms. Must be 0-1000." << endl;
+                return false;
+            }
+            GLOBAL_CONFIG.agingMs = static_cast<uint64_t>(value);
+        }
+        else if (key == "migration-threshold") {
+            int64_t value;
+            file >> value;
+            if (value < 1) {
+                cerr << "Invalid migration-threshold. Must be at least 1." << endl;
+                return false;
+            }
+            GLOBAL_CONFIG.migrationThreshold = clampUint32Range(value);
+        }
+        else if (key == "migration-penalty") {
+            int64_t value;
+            file >> value;
+            if (value < 0 || value > 4294967296LL) {
+                cerr << "Invalid migration-penalty. Must be 0-4294967296." << endl;
+                return false;
+            }
+            GLOBAL_CONFIG.migrationPenalty = static_cast<uint64_t>(value);
+        }
+        else if (key == "util-sample-ms") {
+            int64_t value;
+            file >> value;
+            if (value < 1) {
+                cerr << "Invalid util-sample-ms. Must be at least 1." << endl;
+                return false;
+            }
+            GLOBAL_CONFIG.utilSampleMs = clampUint32Range(value);
+        }
+        else if (key == "util-history") {
+            int64_t value;
+            file >> value;
+            if (value < 1 || value > 3600) {
+                cerr << "Invalid util-history. Must be 1-3600." << endl;
+                return false;
+            }
+            GLOBAL_CONFIG.utilHistory = static_cast<uint64_t>(value);
+        }
+        else if (key == "batch-size") {
+            int64_t value;
+            file >> value;
+            if (value < 1) {
+                cerr << "Invalid batch-size. Must be at least 1." << endl;
+                return false;
+            }
+            GLOBAL_CONFIG.batchSize = clampUint32Range(value);
+        }
+        else if (key == "arrival-dist") {
+            string value;
+            file >> value;
+            if (value != "fixed" && value != "poisson" && value != "bursty") {
+                cerr << "Invalid arrival-dist. Must be 'fixed', 'poisson' or 'bursty'." << endl;
+                return false;
+            }
+            GLOBAL_CONFIG.arrivalDist = value;
+        }
+        else if (key == "log-capacity") {
+            int64_t value;
+            file >> value;
+            if (value < 1) {
+                cerr << "Invalid log-capacity. Must be at least 1." << endl;
+                return false;
+            }
+            GLOBAL_CONFIG.logCapacity = clampUint32Range(value);
+        }
+        else if (key == "log-spill") {
+            string value;
+            file >> value;
+            if (value != "on" && value != "off") {
+                cerr << "Invalid log-spill. Must be 'on' or 'off'." << endl;
+                return false;
+            }
+            GLOBAL_CONFIG.logSpill = value == "on";
+        }
         else {
             cerr << "Unknown config key: " << key << endl;
             return false;
@@ -163,811 +307,3228 @@ bool loadSystemConfig(const string& filename = "config.txt") {
     return true;
 }
 
+// 32-bit process handle: the process table slot in the low 24 bits and the
+// slot's generation in the top 8. Slots are reused, so a handle whose
+// generation no longer matches its slot refers to a process that has since
+// been removed. The pid shown to users is separate and never reused.
+using ProcessHandle = uint32_t;
+const ProcessHandle NO_PROCESS = 0xFFFFFFFFu;
+const uint32_t HANDLE_INDEX_BITS = 24;
+const uint32_t HANDLE_INDEX_MASK = (1u << HANDLE_INDEX_BITS) - 1;
+
 struct Frame {
-    int processId = -1;       // -1 means unused
-    int pageNumber = -1;      // -1 means unassigned
-    string data = "";         // contents in the frame
+    atomic<ProcessHandle> owner = NO_PROCESS;  // written under replMutex
+    atomic<int> pageNumber = -1;      // -1 means unassigned
 };
 
 vector<Frame> physicalMemory;
+vector<uint8_t> physicalArena;  // frame i owns bytes [i * memPerFrame, (i + 1) * memPerFrame)
 
-struct pair_hash {
-    template<typename T1, typename T2>
-    size_t operator()(const pair<T1, T2>& p) const {
-        auto h1 = hash<T1>{}(p.first);
-        auto h2 = hash<T2>{}(p.second);
-        return h1 ^ (h2 << 1); // Combine the hashes
-    }
-};
-
-unordered_map<pair<int, int>, string, pair_hash> backingStore;
-
-void syncBackingStoreToFile() {
-    std::ofstream out(BACKING_FILENAME, std::ios::trunc);
-    for (auto& [key, val] : backingStore) {
-        out << key.first << ' ' << key.second << ' '
-            << std::quoted(val) << "\n";
-    }
+uint8_t* frameData(int frameIndex) {
+    return physicalArena.data() + static_cast<size_t>(frameIndex) * GLOBAL_CONFIG.memPerFrame;
 }
 
-struct PageTableEntry {
-    bool inMemory = false;
-    int frameIndex = -1;  // -1 means not loaded
-};
-
-struct Process {
-    int id;
-    string name;
-    uint64_t currentLine = 0;
-    uint64_t totalLine = 100;
-    string timestamp;
-    int coreAssigned = -1;
-    bool isFinished = false;
-    string finishedTime;
-    vector<string> instructions;
-    unordered_map<string, uint16_t> memory;
-    uint64_t memorySize; // memory size in bytes (must be power of 2)
-    vector<PageTableEntry> pageTable;
-    vector<string> customInstrList;
-    bool   isShutdown = false;
-    string shutdownReason;
-    string shutdownTime;
+enum class ReplacementPolicy : uint8_t {
+    FIFO,           // evict the oldest loaded page
+    LRU,            // evict the least recently touched page
+    CLOCK,          // sweep a hand over the frames, sparing referenced ones once
+    SECOND_CHANCE   // FIFO, but a referenced head is cleared and requeued
 };
 
-queue<pair<int, int>> pageLoadOrder;  // FIFO queue: (processId, pageNumber)
-unordered_map<int, Process*> processLookup;  // pid -> Process*, for eviction tracking
+ReplacementPolicy parseReplacementPolicy(const string& name) {
+    if (name == "lru") return ReplacementPolicy::LRU;
+    if (name == "clock") return ReplacementPolicy::CLOCK;
+    if (name == "second-chance") return ReplacementPolicy::SECOND_CHANCE;
+    return ReplacementPolicy::FIFO;
+}
 
-bool loadPageIfNotInMemory(Process* proc, int pageNumber) {
-    std::lock_guard<std::mutex> lock(memMutex);
+// Intrusive doubly-linked list threaded through the frames. Insert, remove
+// and victim selection are O(1) (amortized for the reference-bit policies)
+// and run under replMutex. touch() is lock-free under every policy: a
+// resident hit only sets the frame's reference bit or, under LRU, its
+// last-use stamp.
+//
+// LRU stamps come from one counter, so they order every use exactly. A hit
+// on the frame that already holds the newest stamp skips the increment, so
+// runs of hits on one page only read the counter. The victim comes from a
+// min-heap of (stamp, frame) entries that is refreshed lazily. Entries are
+// pushed when a frame is positioned. An entry whose frame has been touched
+// since is re-pushed with the new stamp when it reaches the top. The first
+// current entry on top is therefore the exact least recently used frame.
+// This costs O(log n) per touched frame per eviction.
+class PageReplacer {
+private:
+    ReplacementPolicy policy = ReplacementPolicy::FIFO;
+    vector<int> prev, next;        // -1 terminates the list
+    vector<uint8_t> linked;        // frame is in the list
+    unique_ptr<atomic<uint8_t>[]> referenced;   // touched since last positioned
+    unique_ptr<atomic<uint64_t>[]> lastTouch;   // LRU: stamp of last use
+    atomic<uint64_t> useClock = 0;              // LRU: last stamp handed out
+    int head = -1;                 // oldest / least recently used
+    int tail = -1;                 // newest / most recently used
+    int hand = -1;                 // CLOCK hand; -1 means start at head
+
+    void unlink(int f) {
+        if (hand == f) hand = next[f];
+        if (prev[f] != -1) next[prev[f]] = next[f]; else head = next[f];
+        if (next[f] != -1) prev[next[f]] = prev[f]; else tail = prev[f];
+        prev[f] = next[f] = -1;
+        linked[f] = 0;
+    }
 
-    if (!proc || pageNumber < 0 || pageNumber >= static_cast<int>(proc->pageTable.size())) {
-        return false; // Invalid process or page number
+    void pushBack(int f) {
+        prev[f] = tail;
+        next[f] = -1;
+        if (tail != -1) next[tail] = f; else head = f;
+        tail = f;
+        linked[f] = 1;
+        if (policy == ReplacementPolicy::LRU) pushUse(f, lastTouch[f].load(memory_order_relaxed));
     }
 
-    PageTableEntry& entry = proc->pageTable[pageNumber];
-    if (entry.inMemory) return true; // Already in memory
+    // LRU heap entry; only the newest entry of a linked frame is current
+    struct UseEntry {
+        uint64_t stamp;
+        int frame;
+        uint32_t version;
 
-    // === Try to find a free frame ===
-    for (size_t i = 0; i < physicalMemory.size(); ++i) {
-        if (physicalMemory[i].processId == -1) {
-            entry.inMemory = true;
-            entry.frameIndex = static_cast<int>(i);
+        bool operator>(const UseEntry& other) const { return stamp > other.stamp; }
+    };
 
-            physicalMemory[i].processId = proc->id;
-            physicalMemory[i].pageNumber = pageNumber;
+    vector<UseEntry> useHeap;      // LRU: min-heap on stamp
+    vector<uint32_t> useVersion;   // LRU: version of each frame's current entry
 
-            pageInCount++;
+    uint64_t nextStamp() { return useClock.fetch_add(1, memory_order_relaxed) + 1; }
 
-            // Restore from backing store if available
-            auto it = backingStore.find({ proc->id, pageNumber });
-            if (it != backingStore.end()) {
-                physicalMemory[i].data = it->second;
-                backingStore.erase(it);
-            }
-            else {
-                physicalMemory[i].data = "";
-            }
+    void pushUse(int f, uint64_t stamp) {
+        // Entries of removed frames pile up; rebuild before they dominate
+        if (useHeap.size() >= 4 * linked.size() + 16) compactUses();
+        useHeap.push_back({ stamp, f, ++useVersion[f] });
+        push_heap(useHeap.begin(), useHeap.end(), greater<UseEntry>());
+    }
 
-            // Avoid duplicate entries in pageLoadOrder
-            bool alreadyQueued = false;
-            queue<pair<int, int>> tempQueue;
-            while (!pageLoadOrder.empty()) {
-                auto front = pageLoadOrder.front(); pageLoadOrder.pop();
-                if (front == make_pair(proc->id, pageNumber)) {
-                    alreadyQueued = true;
-                }
-                tempQueue.push(front);
-            }
-            swap(pageLoadOrder, tempQueue);
+    void compactUses() {
+        useHeap.clear();
+        for (size_t f = 0; f < linked.size(); ++f) {
+            if (!linked[f]) continue;
+            useHeap.push_back({ lastTouch[f].load(memory_order_relaxed),
+                static_cast<int>(f), ++useVersion[f] });
+        }
+        make_heap(useHeap.begin(), useHeap.end(), greater<UseEntry>());
+    }
 
-            if (!alreadyQueued) {
-                pageLoadOrder.emplace(proc->id, pageNumber);
+    // Least recently used linked frame, or -1 if none is linked
+    int lruVictim() {
+        while (!useHeap.empty()) {
+            UseEntry top = useHeap.front();
+            pop_heap(useHeap.begin(), useHeap.end(), greater<UseEntry>());
+            useHeap.pop_back();
+            int f = top.frame;
+            if (!linked[f] || top.version != useVersion[f]) continue;   // superseded
+            uint64_t stamp = lastTouch[f].load(memory_order_relaxed);
+            if (stamp != top.stamp) {
+                pushUse(f, stamp);    // touched since it was positioned
+                continue;
             }
-
-            return true;
+            return f;
         }
+        return -1;
     }
 
-    // === No free frame: apply FIFO eviction ===
-    if (!pageLoadOrder.empty()) {
-        auto [evictedPID, evictedPageNum] = pageLoadOrder.front();
-        pageLoadOrder.pop();
-
-        Process* evictedProc = processLookup.count(evictedPID) ? processLookup[evictedPID] : nullptr;
-        if (!evictedProc) return false;
-
-        PageTableEntry& evictedEntry = evictedProc->pageTable[evictedPageNum];
-        int victimFrameIdx = evictedEntry.frameIndex;
-
-        // Save evicted content to backing store
-        backingStore[{evictedPID, evictedPageNum}] = physicalMemory[victimFrameIdx].data;
-
-        pageOutCount++;
-        syncBackingStoreToFile();
-
-        // Invalidate evicted page
-        evictedEntry.inMemory = false;
-        evictedEntry.frameIndex = -1;
-
-        // Load new page into the evicted frame
-        entry.inMemory = true;
-        entry.frameIndex = victimFrameIdx;
+public:
+    void reset(size_t numFrames, ReplacementPolicy newPolicy) {
+        policy = newPolicy;
+        prev.assign(numFrames, -1);
+        next.assign(numFrames, -1);
+        linked.assign(numFrames, 0);
+        referenced = make_unique<atomic<uint8_t>[]>(numFrames);
+        lastTouch = make_unique<atomic<uint64_t>[]>(numFrames);
+        useClock = 0;
+        useHeap.clear();
+        useVersion.assign(numFrames, 0);
+        head = tail = hand = -1;
+    }
 
-        pageInCount++;
+    ReplacementPolicy getPolicy() const { return policy; }
 
-        physicalMemory[victimFrameIdx].processId = proc->id;
-        physicalMemory[victimFrameIdx].pageNumber = pageNumber;
+    // A page was just loaded into frame f
+    void insert(int f) {
+        referenced[f] = 1;
+        lastTouch[f] = nextStamp();
+        if (linked[f] && policy == ReplacementPolicy::CLOCK) return;  // reused in place behind the hand
+        if (linked[f]) unlink(f);
+        pushBack(f);
+    }
 
-        // Restore data from backing store
-        auto it = backingStore.find({ proc->id, pageNumber });
-        if (it != backingStore.end()) {
-            physicalMemory[victimFrameIdx].data = it->second;
-            backingStore.erase(it);
-            syncBackingStoreToFile();
+    // Frame f was accessed while resident. Safe without replMutex.
+    void touch(int f) {
+        if (policy == ReplacementPolicy::FIFO) return;
+        if (policy == ReplacementPolicy::LRU) {
+            if (lastTouch[f].load(memory_order_relaxed) == useClock.load(memory_order_relaxed)) return;
+            lastTouch[f].store(nextStamp(), memory_order_relaxed);
         }
         else {
-            physicalMemory[victimFrameIdx].data = "";
+            referenced[f].store(1, memory_order_relaxed);
         }
+    }
+
+    // Frame f no longer holds a page
+    void remove(int f) {
+        if (linked[f]) unlink(f);
+    }
+
+    // Puts back a victim whose owner could not be locked
+    void requeue(int f) {
+        if (!linked[f]) pushBack(f);
+    }
 
-        // Avoid duplicate entries in pageLoadOrder
-        bool alreadyQueued = false;
-        queue<pair<int, int>> tempQueue;
-        while (!pageLoadOrder.empty()) {
-            auto front = pageLoadOrder.front(); pageLoadOrder.pop();
-            if (front == make_pair(proc->id, pageNumber)) {
-                alreadyQueued = true;
+    // Picks the frame to evict, or -1 if nothing is resident. The frame is
+    // unlinked except under CLOCK, where it keeps its slot on the dial.
+    int victim() {
+        if (head == -1) return -1;
+        int f = head;   // FIFO: the head is the victim
+        if (policy == ReplacementPolicy::LRU) {
+            f = lruVictim();
+            if (f == -1) return -1;
+        }
+        else if (policy == ReplacementPolicy::SECOND_CHANCE) {
+            while (referenced[f].exchange(0)) {
+                unlink(f);
+                pushBack(f);
+                f = head;
             }
-            tempQueue.push(front);
         }
-        swap(pageLoadOrder, tempQueue);
-
-        if (!alreadyQueued) {
-            pageLoadOrder.emplace(proc->id, pageNumber);
+        else if (policy == ReplacementPolicy::CLOCK) {
+            f = hand != -1 ? hand : head;
+            while (referenced[f].exchange(0)) {
+                f = next[f] != -1 ? next[f] : head;
+            }
+            hand = next[f];
+            return f;
         }
-
-        return true;
+        unlink(f);
+        return f;
     }
+};
 
-    return false; // No free frame and nothing to evict
-}
+PageReplacer pageReplacer;
 
+// Free frames are kept on a stack so a fault never scans physicalMemory, and
+// the used-frame count is maintained alongside it for the stats commands.
+class FrameAllocator {
+private:
+    vector<int> freeFrames;
+    vector<char> isFree;        // index = frame, guards against double release
+    atomic<size_t> usedFrames = 0;
 
+public:
+    void reset(size_t numFrames) {
+        freeFrames.clear();
+        freeFrames.reserve(numFrames);
+        for (size_t i = numFrames; i > 0; --i) {
+            freeFrames.push_back(static_cast<int>(i - 1));   // hand out frame 0 first
+        }
+        isFree.assign(numFrames, 1);
+        usedFrames = 0;
+    }
 
+    // Returns a free frame index, or -1 if every frame is in use
+    int allocate() {
+        if (freeFrames.empty()) return -1;
+        int f = freeFrames.back();
+        freeFrames.pop_back();
+        isFree[f] = 0;
+        usedFrames++;
+        return f;
+    }
 
-void printHeader() {
-    cout << " _____  _____   ____  _____  ______  _______     __" << endl;
-    cout << "/ ____|/ ____| / __ \\|  __ \\|  ____|/ ____\\ \\   / /" << endl;
-    cout << "| |    | (___ | |  | | |__) | |__  | (___  \\ \\_/ /" << endl;
-    cout << "| |     \\___ \\| |  | |  ___/|  __|  \\___ \\  \\   /" << endl;
-    cout << "| |____ ____) | |__| | |    | |____ ____) |  | |" << endl;
-    cout << " \\_____|_____/ \\____/|_|    |______|_____/   |_|" << endl;
-    cout << "\033[32m";
-    cout << "Hello, Welcome to CSOPESY command line!" << endl;
-    cout << "\033[33m";
-    cout << "Type 'exit' to quit, 'clear' to clear the screen" << endl;
-    cout << "\033[0m";
-}
+    // Returns false, changing nothing, for a frame that is not allocated
+    bool release(int f) {
+        if (f < 0 || static_cast<size_t>(f) >= isFree.size() || isFree[f]) return false;
+        isFree[f] = 1;
+        freeFrames.push_back(f);
+        usedFrames--;
+        return true;
+    }
 
-void clearScreen() {
-    cout << "\033[2J\033[1;1H";
-}
+    size_t used() const { return usedFrames.load(); }
+};
 
-string generateTimestamp() {
-    auto now = time(nullptr);
-    tm localTime;
-#ifdef _WIN32   
-    localtime_s(&localTime, &now); // Windows
-#else
-    localtime_r(&now, &localTime); // POSIX (macOS, Linux)
-#endif
+FrameAllocator frameAllocator;
+
+// Lists the non-zero bytes of a page as "(0xADDR value)" pairs
+string formatPageBytes(const uint8_t* data, uint64_t baseAddress) {
     stringstream ss;
-    ss << put_time(&localTime, "%m/%d/%Y %I:%M:%S%p");
+    for (uint64_t i = 0; i < GLOBAL_CONFIG.memPerFrame; ++i) {
+        if (data[i] == 0) continue;
+        ss << "(0x" << hex << baseAddress + i << " " << dec << static_cast<int>(data[i]) << ")";
+    }
     return ss.str();
 }
 
-uint64_t cpuBurstGenerator() {
-    std::random_device rd;
-    std::mt19937_64 gen(rd()); // use 64-bit generator
-    std::uniform_int_distribution<uint64_t> distrib(GLOBAL_CONFIG.minInstructions, GLOBAL_CONFIG.maxInstructions);
-
-    return distrib(gen);
-}
+struct pair_hash {
+    template<typename T1, typename T2>
+    size_t operator()(const pair<T1, T2>& p) const {
+        auto h1 = hash<T1>{}(p.first);
+        auto h2 = hash<T2>{}(p.second);
+        return h1 ^ (h2 << 1); // Combine the hashes
+    }
+};
 
-uint64_t generateRandomMemSize() {
-    static const vector<uint64_t> pow2 = {
-        64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536
+// Binary backing store: every (pid, page) that has ever been paged out owns a
+// fixed memPerFrame-byte slot in BACKING_STORE_BIN, written and read in place.
+// A page-out therefore costs a single page-sized write instead of a rewrite of
+// the whole store. A slot is valid while its page is not resident.
+class BackingStore {
+private:
+    struct SlotInfo {
+        uint64_t slot = 0;
+        bool valid = false;    // slot holds the page's current contents
     };
 
-    vector<uint64_t> filtered;
-    for (uint64_t val : pow2) {
-        if (val >= GLOBAL_CONFIG.minMemPerProc && val <= GLOBAL_CONFIG.maxMemPerProc) {
-            filtered.push_back(val);
+    fstream file;
+    uint64_t pageSize = 0;
+    unordered_map<pair<int, int>, SlotInfo, pair_hash> slots;
+    vector<uint64_t> freeSlots;
+    uint64_t nextSlot = 0;
+    size_t validCount = 0;
+    mutable mutex storeMutex;
+
+    using SlotMap = unordered_map<pair<int, int>, SlotInfo, pair_hash>;
+
+    SlotMap::iterator releaseSlot(SlotMap::iterator it) {
+        if (it->second.valid) validCount--;
+        freeSlots.push_back(it->second.slot);
+        return slots.erase(it);
+    }
+
+public:
+    void reset(uint64_t newPageSize) {
+        lock_guard<mutex> lock(storeMutex);
+        if (file.is_open()) file.close();
+        file.open(BACKING_STORE_BIN, ios::in | ios::out | ios::binary | ios::trunc);
+        if (!file.is_open()) {
+            cerr << "Error: Could not open " << BACKING_STORE_BIN << endl;
         }
+        pageSize = newPageSize;
+        slots.clear();
+        freeSlots.clear();
+        nextSlot = 0;
+        validCount = 0;
     }
 
-    if (filtered.empty()) {
-        throw runtime_error("No valid power-of-2 memory size within range.");
+    // Writes one page into its slot, allocating the slot on first page-out
+    void savePage(int pid, int pageNumber, const uint8_t* data) {
+        lock_guard<mutex> lock(storeMutex);
+        auto [it, inserted] = slots.try_emplace({ pid, pageNumber });
+        SlotInfo& info = it->second;
+        if (inserted) {
+            if (!freeSlots.empty()) {
+                info.slot = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            else {
+                info.slot = nextSlot++;
+            }
+        }
+        file.seekp(static_cast<streamoff>(info.slot * pageSize));
+        file.write(reinterpret_cast<const char*>(data), static_cast<streamsize>(pageSize));
+        file.flush();
+        if (!info.valid) validCount++;
+        info.valid = true;
     }
 
-    static thread_local mt19937 gen(random_device{}());
-    uniform_int_distribution<> dist(0, static_cast<int>(filtered.size()) - 1);
+    // Reads a page back for page-in. The slot stays allocated but is no longer
+    // valid, since the resident frame now owns the page's contents.
+    bool loadPage(int pid, int pageNumber, uint8_t* out) {
+        lock_guard<mutex> lock(storeMutex);
+        auto it = slots.find({ pid, pageNumber });
+        if (it == slots.end() || !it->second.valid) return false;
+        file.seekg(static_cast<streamoff>(it->second.slot * pageSize));
+        file.read(reinterpret_cast<char*>(out), static_cast<streamsize>(pageSize));
+        if (!file) {
+            file.clear();
+            return false;
+        }
+        it->second.valid = false;
+        validCount--;
+        return true;
+    }
 
-    return filtered[dist(gen)];
-}
+    // Returns a page's slot to the free list without touching the file
+    void discardPage(int pid, int pageNumber) {
+        lock_guard<mutex> lock(storeMutex);
+        auto it = slots.find({ pid, pageNumber });
+        if (it == slots.end()) return;
+        releaseSlot(it);
+    }
 
-uint64_t generateRandomDataAddress(uint64_t minAddr, uint64_t maxAddr) {
-    static thread_local mt19937 gen(random_device{}());
-    uniform_int_distribution<uint64_t> dist(minAddr, maxAddr);
-    return dist(gen);
-}
+    // Drops every slot of a process that has finished or been shut down
+    void discardProcess(int pid) {
+        lock_guard<mutex> lock(storeMutex);
+        for (auto it = slots.begin(); it != slots.end();) {
+            it = it->first.first == pid ? releaseSlot(it) : next(it);
+        }
+    }
 
+    size_t size() const {
+        lock_guard<mutex> lock(storeMutex);
+        return validCount;
+    }
 
-void instructions_manager(
-    uint64_t currentLine,
-    vector<string>& instructions,
-    unordered_map<string, uint16_t>& memory,
-    const string& processName,
-    int coreId,
-    Process* proc
-) {
-    // 0) If already shutdown, do nothing
-    if (proc->isShutdown) return;
+    // Visits every valid page in (pid, page) order: fn(pid, pageNumber, bytes)
+    template<typename Fn>
+    void forEachPage(Fn fn) {
+        lock_guard<mutex> lock(storeMutex);
+        vector<pair<pair<int, int>, uint64_t>> valid;
+        for (auto& [key, info] : slots) {
+            if (info.valid) valid.push_back({ key, info.slot });
+        }
+        sort(valid.begin(), valid.end());
+        vector<uint8_t> buffer(pageSize);
+        for (auto& [key, slot] : valid) {
+            file.seekg(static_cast<streamoff>(slot * pageSize));
+            file.read(reinterpret_cast<char*>(buffer.data()), static_cast<streamsize>(pageSize));
+            if (!file) {
+                file.clear();
+                continue;
+            }
+            fn(key.first, key.second, buffer.data());
+        }
+    }
+};
 
-    // 1) Ensure instructions has enough space
-    if (instructions.size() <= currentLine)
-        instructions.resize(currentLine + 1);
+BackingStore backingStore;
 
-    // 2) Common prefix
-    string prefix = "(" + generateTimestamp() + ") Core: " + to_string(coreId) + " ";
+// Write-back pipeline for evicted pages. The fault path only copies the victim
+// frame into a bounded queue; a background flusher batches the writes to the
+// backing store, so disk I/O never runs under a memory lock. A page faulted back in
+// while still queued is served straight from the queue.
+class WritebackQueue {
+private:
+    struct PendingPage {
+        vector<uint8_t> data;
+        uint64_t seq = 0;          // bumped when a newer copy replaces this one
+    };
 
-    // 3) If we still have custom instructions queued, run those first:
-    if (currentLine < proc->customInstrList.size()) {
-        const string& instr = proc->customInstrList[currentLine];
-        smatch m;
-        stringstream log;
+    static constexpr size_t CAPACITY = 64;     // pages held before evictors wait
+    static constexpr size_t BATCH_SIZE = 16;   // pages written per flusher pass
+
+    unordered_map<pair<int, int>, PendingPage, pair_hash> pending;
+    deque<pair<pair<int, int>, uint64_t>> order;   // (key, seq) in eviction order
+    uint64_t nextSeq = 0;
+    mutex wbMutex;
+    condition_variable workCv;
+    condition_variable spaceCv;
+    thread flusher;
+    bool stopping = false;
+
+    atomic<uint64_t> pagesFlushed = 0;
+    atomic<uint64_t> batchesFlushed = 0;
+    atomic<uint64_t> servedFromQueue = 0;
+    atomic<uint64_t> totalFlushNs = 0;
+    atomic<uint64_t> maxFlushNs = 0;
+
+    void run() {
+        vector<pair<pair<int, int>, PendingPage>> batch;
+        while (true) {
+            batch.clear();
+            {
+                unique_lock<mutex> lock(wbMutex);
+                workCv.wait(lock, [this] { return !order.empty() || stopping; });
+                if (order.empty() && stopping) return;
+                while (!order.empty() && batch.size() < BATCH_SIZE) {
+                    auto [key, seq] = order.front();
+                    order.pop_front();
+                    auto it = pending.find(key);
+                    if (it != pending.end() && it->second.seq == seq) {
+                        batch.emplace_back(key, it->second);   // copy; entry stays visible to faults
+                    }
+                }
+            }
 
-        // --- DECLARE <var> <value> ---
-        if (regex_match(instr, m, regex(R"(DECLARE\s+([A-Za-z_]\w*)\s+(\d+))"))) {
-            string var = m[1], val = m[2];
-            memory[var] = static_cast<uint16_t>(stoi(val));
-            if (loadPageIfNotInMemory(proc, 0)) {
-                int f = proc->pageTable[0].frameIndex;
-                lock_guard<mutex> L(memMutex);
-                physicalMemory[f].data += "(" + var + " " + val + ")";
+            auto start = chrono::steady_clock::now();
+            for (auto& [key, page] : batch) {
+                backingStore.savePage(key.first, key.second, page.data.data());
+            }
+            uint64_t ns = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now() - start).count());
+
+            {
+                lock_guard<mutex> lock(wbMutex);
+                for (auto& [key, page] : batch) {
+                    auto it = pending.find(key);
+                    if (it == pending.end()) {
+                        // Faulted back in, or its process retired, while being
+                        // written: the slot is not needed
+                        backingStore.discardPage(key.first, key.second);
+                    }
+                    else if (it->second.seq == page.seq) {
+                        pending.erase(it);
+                    }
+                }
+            }
+            spaceCv.notify_all();
+
+            if (!batch.empty()) {
+                pagesFlushed += batch.size();
+                batchesFlushed++;
+                totalFlushNs += ns;
+                uint64_t prevMax = maxFlushNs.load();
+                while (ns > prevMax && !maxFlushNs.compare_exchange_weak(prevMax, ns)) {}
             }
-            log << "DECLARE " << var << " = " << val;
         }
+    }
 
-        // --- ADD <dst> <a> <b> ---
-        else if (regex_match(instr, m, regex(R"(ADD\s+([A-Za-z_]\w*)\s+([A-Za-z_]\w*)\s+([A-Za-z_]\w*))"))) {
-            string dst = m[1], a = m[2], b = m[3];
-            uint16_t res = clampUint16(memory[a] + memory[b]);
-            memory[dst] = res;
-            log << "ADD " << a << "(" << memory[a] << ") + "
-                << b << "(" << memory[b] << ") = " << res;
-        }
+public:
+    void start() {
+        lock_guard<mutex> lock(wbMutex);
+        stopping = false;
+        pending.clear();
+        order.clear();
+        flusher = thread(&WritebackQueue::run, this);
+    }
 
-        // --- SUBTRACT <dst> <a> <b> ---
-        else if (regex_match(instr, m, regex(R"(SUBTRACT\s+([A-Za-z_]\w*)\s+([A-Za-z_]\w*)\s+([A-Za-z_]\w*))"))) {
-            string dst = m[1], a = m[2], b = m[3];
-            uint16_t res = clampUint16(memory[a] - memory[b]);
-            memory[dst] = res;
-            log << "SUBTRACT " << a << "(" << memory[a] << ") - "
-                << b << "(" << memory[b] << ") = " << res;
+    // Drains everything still queued, then joins the flusher
+    void stop() {
+        {
+            lock_guard<mutex> lock(wbMutex);
+            if (!flusher.joinable()) return;
+            stopping = true;
         }
+        workCv.notify_all();
+        flusher.join();
+    }
 
-        // --- WRITE 0xHEXADDR <value|var> ---
-        else if (regex_match(instr, m, regex(R"(WRITE\s+(0x[0-9A-Fa-f]+)\s+(\d+|[A-Za-z_]\w*))"))) {
-            string addrHex = m[1];
-            string tok = m[2];
-            uint64_t address = stoull(addrHex, nullptr, 16);
-
-            // --- bounds check ---
-            if (address < 64 || address >= proc->memorySize) {
-                proc->isShutdown = true;
-                proc->shutdownReason = "Memory access violation at " + addrHex;
-                proc->shutdownTime = generateTimestamp();
-                instructions[currentLine]
-                    = prefix + "\"" + proc->shutdownReason + "\"";
-                return;
-            }
+    // Queues a copy of an evicted page, waiting while the queue is full
+    void enqueue(int pid, int pageNumber, const uint8_t* data) {
+        unique_lock<mutex> lock(wbMutex);
+        pair<int, int> key{ pid, pageNumber };
+        spaceCv.wait(lock, [&] { return pending.size() < CAPACITY || pending.count(key) || stopping; });
+        PendingPage& page = pending[key];
+        page.data.assign(data, data + GLOBAL_CONFIG.memPerFrame);
+        page.seq = ++nextSeq;
+        order.emplace_back(key, page.seq);
+        lock.unlock();
+        workCv.notify_one();
+    }
 
-            uint16_t val = isdigit(tok[0])
-                ? static_cast<uint16_t>(stoi(tok))
-                : memory[tok];
+    // Page-in fast path: copies a still-queued page into `out` and drops it
+    bool takeIfPending(int pid, int pageNumber, uint8_t* out) {
+        {
+            lock_guard<mutex> lock(wbMutex);
+            auto it = pending.find({ pid, pageNumber });
+            if (it == pending.end()) return false;
+            memcpy(out, it->second.data.data(), GLOBAL_CONFIG.memPerFrame);
+            pending.erase(it);
+        }
+        servedFromQueue++;
+        spaceCv.notify_one();
+        return true;
+    }
 
-            size_t pageNum = min<uint64_t>(
-                address / GLOBAL_CONFIG.memPerFrame,
-                proc->pageTable.size() - 1
-            );
-            bool loaded = loadPageIfNotInMemory(proc, pageNum);
-            if (loaded) {
-                int f = proc->pageTable[pageNum].frameIndex;
-                lock_guard<mutex> L(memMutex);
-                physicalMemory[f].data += "(" + addrHex + " " + to_string(val) + ")";
+    // Drops every queued page of a retired process
+    void discardProcess(int pid) {
+        {
+            lock_guard<mutex> lock(wbMutex);
+            for (auto it = pending.begin(); it != pending.end();) {
+                it = it->first.first == pid ? pending.erase(it) : next(it);
             }
-            memory[addrHex] = val;
-            log << "WRITE " << addrHex << " " << val;
+        }
+        spaceCv.notify_all();
+    }
+
+    // Visits every queued page: fn(pid, pageNumber, bytes)
+    template<typename Fn>
+    void forEachPending(Fn fn) {
+        lock_guard<mutex> lock(wbMutex);
+        for (auto& [key, page] : pending) fn(key.first, key.second, page.data.data());
+    }
+
+    void printStats() {
+        size_t depth;
+        {
+            lock_guard<mutex> lock(wbMutex);
+            depth = pending.size();
+        }
+        uint64_t batches = batchesFlushed.load();
+        double avgUs = batches ? totalFlushNs.load() / 1000.0 / batches : 0.0;
+        cout << "Queue depth      : " << depth << " / " << CAPACITY << endl;
+        cout << "Pages flushed    : " << pagesFlushed.load() << endl;
+        cout << "Flush batches    : " << batches << endl;
+        cout << "Served from queue: " << servedFromQueue.load() << endl;
+        cout << fixed << setprecision(2)
+            << "Flush latency    : avg " << avgUs << " us, max "
+            << maxFlushNs.load() / 1000.0 << " us" << endl;
+    }
+};
+
+WritebackQueue writeback;
+
+// Debug aid: writes every valid backing-store page to BACKING_FILENAME as
+// "pid page hexbytes" lines
+void dumpBackingStoreToText() {
+    std::ofstream out(BACKING_FILENAME, std::ios::trunc);
+    auto writeLine = [&](int pid, int pageNumber, const uint8_t* data) {
+        out << pid << ' ' << pageNumber << ' ' << hex << setfill('0');
+        for (uint64_t i = 0; i < GLOBAL_CONFIG.memPerFrame; ++i) out << setw(2) << static_cast<int>(data[i]);
+        out << dec << setfill(' ') << "\n";
+    };
+    backingStore.forEachPage(writeLine);
+    writeback.forEachPending(writeLine);
+}
+
+struct PageTableEntry {
+    bool inMemory = false;
+    int frameIndex = -1;  // -1 means not loaded
+};
+
+// Decoded form of a `screen -c` instruction. Programs are compiled once when
+// the process is created so the execute path never touches a regex.
+enum class OpCode : uint8_t {
+    DECLARE,    // dst = imm
+    ADD,        // dst = a + b
+    SUBTRACT,   // dst = a - b
+    WRITE,      // [address] = imm or b
+    READ,       // dst = [address]
+    PRINT       // print a
+};
+
+struct Instruction {
+    OpCode   op = OpCode::PRINT;
+    bool     srcIsImm = false;   // WRITE: store imm instead of slot b
+    uint16_t dst = 0;            // operand slots index Process::symbols
+    uint16_t a = 0;
+    uint16_t b = 0;
+    uint16_t imm = 0;
+    uint64_t address = 0;        // pre-parsed hex address for READ/WRITE
+};
+
+// Per-process variables. Names are interned once into dense uint16 slots so
+// instructions index `values` directly instead of hashing a string each time.
+struct SymbolTable {
+    vector<string> names;                    // slot -> name
+    vector<uint16_t> values;                 // slot -> value
+    unordered_map<string, uint16_t> slots;   // name -> slot, used only by intern
+
+    size_t size() const { return names.size(); }
+    bool empty() const { return names.empty(); }
+
+    // Returns the slot for `name`, adding it with value 0 on first use
+    uint16_t intern(const string& name) {
+        auto it = slots.find(name);
+        if (it != slots.end()) return it->second;
+        uint16_t slot = static_cast<uint16_t>(names.size());
+        names.push_back(name);
+        values.push_back(0);
+        slots.emplace(name, slot);
+        return slot;
+    }
+};
+
+const string LOG_SEGMENT_DIR = "csopesy-logs";   // per-process spill segments
+
+enum class LogOp : uint8_t {
+    DECLARE, DECLARE_IGNORED, ADD, SUBTRACT, WRITE, READ, PRINT, SLEEP, FOR, VIOLATION
+};
+
+// LogRecord::flags
+const uint8_t LOG_CUSTOM = 1;           // from a `screen -c` program (its own wording)
+const uint8_t LOG_PAGE_LOADED = 2;      // the accessed page was resident or faulted in
+const uint8_t LOG_PAGE0_WARNING = 4;    // the symbol table page could not be loaded
+
+// One executed instruction, fixed-size so the hot path only copies it into
+// the log. Variables are kept as symbol slots and everything is turned into
+// text by formatLogRecord() when the log is actually viewed.
+struct LogRecord {
+    int64_t  wallTime = 0;      // time_t of execution
+    uint64_t line = 0;          // instruction line executed
+    uint64_t address = 0;       // READ/WRITE/violation address
+    uint32_t page = 0;          // page reported for random READ/WRITE
+    uint16_t core = 0;
+    uint16_t dst = 0;           // symbol slots
+    uint16_t a = 0;
+    uint16_t b = 0;
+    uint16_t valA = 0;          // operand values; FOR: start value
+    uint16_t valB = 0;          // FOR: iteration count
+    uint16_t result = 0;
+    LogOp    op = LogOp::DECLARE;
+    uint8_t  flags = 0;
+};
+
+// Per-process instruction log holding only the newest `capacity` records, so
+// host memory stays flat however many instructions run. The ring grows with
+// the log up to `capacity`, so a short process never pays for the full ring.
+// With a segment path set, records pushed out of the ring are appended to
+// that file instead of being dropped; being fixed-size, any of them can be
+// read back by offset. Spilled records are written in batches, opening and
+// closing the file each time, so idle logs hold no file handles.
+class InstructionLog {
+public:
+    void configure(size_t capacity, const string& segmentPath) {
+        lock_guard<mutex> lock(logMutex);
+        vector<LogRecord>().swap(ring);
+        this->capacity = max<size_t>(capacity, 1);
+        total = 0;
+        path = segmentPath;
+        spilled = 0;
+        pendingSpill.clear();
+    }
+
+    // Frees the ring and deletes the spill segment once nobody can view them
+    void release() {
+        lock_guard<mutex> lock(logMutex);
+        vector<LogRecord>().swap(ring);
+        vector<LogRecord>().swap(pendingSpill);
+        total = 0;
+        if (spilled > 0) {
+            error_code ec;
+            filesystem::remove(path, ec);
+        }
+        spilled = 0;
+        path.clear();
+    }
+
+    void append(const LogRecord& record) {
+        lock_guard<mutex> lock(logMutex);
+        if (ring.size() < capacity) {
+            // Still filling: grow geometrically, but never past capacity
+            if (ring.size() == ring.capacity()) {
+                ring.reserve(min(capacity, max<size_t>(16, ring.size() * 2)));
+            }
+            ring.push_back(record);
+            ++total;
+            return;
+        }
+        size_t slot = static_cast<size_t>(total % capacity);
+        if (!path.empty()) spill(ring[slot]);
+        ring[slot] = record;
+        ++total;
+    }
+
+    // Total records ever appended
+    uint64_t size() const {
+        lock_guard<mutex> lock(logMutex);
+        return total;
+    }
+
+    // Index of the oldest record that can still be read
+    uint64_t firstAvailable() const {
+        lock_guard<mutex> lock(logMutex);
+        return path.empty() ? oldestInRing() : 0;
+    }
+
+    // Appends records [from, from + count) to `out`, reading any that were
+    // spilled back from the segment file or the batch not yet written
+    void read(uint64_t from, size_t count, vector<LogRecord>& out) const {
+        lock_guard<mutex> lock(logMutex);
+        uint64_t end = min<uint64_t>(from + count, total);
+        uint64_t ringStart = oldestInRing();
+
+        if (from < ringStart && !path.empty()) {
+            readSpilled(from, min(end, ringStart), out);
+            from = ringStart;
+        }
+        for (uint64_t i = max(from, ringStart); i < end; ++i) {
+            out.push_back(ring[static_cast<size_t>(i % capacity)]);
+        }
+    }
+
+private:
+    static constexpr size_t SPILL_BATCH = 64;   // records per segment write
+
+    uint64_t oldestInRing() const {
+        return total > capacity ? total - capacity : 0;
+    }
+
+    void spill(const LogRecord& record) {
+        pendingSpill.push_back(record);
+        if (pendingSpill.size() >= SPILL_BATCH) flushSpill();
+    }
+
+    // Appends the pending batch to the segment. If the file cannot be
+    // written the log falls back to keeping only the ring, so nothing claims
+    // to be on disk that is not.
+    void flushSpill() {
+        ofstream segment(path, ios::binary | ios::out | (spilled == 0 ? ios::trunc : ios::app));
+        if (segment) {
+            segment.write(reinterpret_cast<const char*>(pendingSpill.data()),
+                static_cast<streamsize>(pendingSpill.size() * sizeof(LogRecord)));
+            segment.close();
+        }
+        if (!segment.good()) {
+            cerr << "Log spill to " << path << " failed; older entries of this process are dropped." << endl;
+            error_code ec;
+            filesystem::remove(path, ec);
+            path.clear();
+            spilled = 0;
+            pendingSpill.clear();
+            return;
+        }
+        spilled += pendingSpill.size();
+        pendingSpill.clear();
+    }
+
+    // Records below `spilled` are in the segment; the rest are still pending
+    void readSpilled(uint64_t from, uint64_t end, vector<LogRecord>& out) const {
+        if (from < spilled) {
+            ifstream in(path, ios::binary);
+            in.seekg(static_cast<streamoff>(from * sizeof(LogRecord)));
+            LogRecord record;
+            for (uint64_t i = from; i < min(end, spilled); ++i) {
+                if (!in.read(reinterpret_cast<char*>(&record), sizeof(LogRecord))) break;
+                out.push_back(record);
+            }
+        }
+        for (uint64_t i = max(from, spilled); i < end; ++i) {
+            out.push_back(pendingSpill[static_cast<size_t>(i - spilled)]);
+        }
+    }
+
+    mutable mutex logMutex;       // core thread appends, the shell reads
+    vector<LogRecord> ring;       // grows to `capacity`, then wraps
+    size_t capacity = 1;
+    uint64_t total = 0;
+    string path;                  // empty: records leaving the ring are dropped
+    uint64_t spilled = 0;         // records written to the segment
+    vector<LogRecord> pendingSpill;   // records [spilled, spilled + size) not yet written
+};
+
+// "MM/DD/YYYY HH:MM:SSAM" held inline, so copying one never allocates
+struct Timestamp {
+    char text[24] = {};
+};
+
+ostream& operator<<(ostream& os, const Timestamp& ts) {
+    return os << ts.text;
+}
+
+struct Process {
+    mutable mutex ptMutex;          // guards pageTable and this process' frames
+    int id;                         // assigned by processTable.insert
+    ProcessHandle handle = NO_PROCESS;
+    string name;
+    atomic<uint64_t> currentLine = 0;   // advanced by the running core, read by reports
+    uint64_t totalLine = 100;
+    Timestamp timestamp;
+    atomic<int> coreAssigned = -1;
+    atomic<bool> isFinished = false;    // set after finishedTime
+    Timestamp finishedTime;
+    InstructionLog instructions;    // newest log-capacity executed lines
+    SymbolTable vars;               // variables, interned into dense slots
+    mutable mutex varsMutex;        // guards vars.names growth against log viewers
+    uint64_t memorySize; // memory size in bytes (must be power of 2)
+    vector<PageTableEntry> pageTable;
+    atomic<uint32_t> residentPages = 0;  // pageTable entries with inMemory set
+    // State transitions in clockService.monotonicNs(); written by whoever
+    // holds the process (creator, scheduler or running core)
+    int64_t arrivalNs = 0;               // created and first enqueued
+    int64_t readyNs = 0;                 // last enqueue or preemption
+    int64_t finishNs = -1;               // finished or shut down
+    int64_t waitNs = 0;                  // total time ready but not running
+    atomic<uint32_t> migrations = 0;     // dispatches onto a core other than the last one
+    int schedLevel = 0;                  // MLFQ level, set when queued
+    uint64_t schedEpoch = 0;             // MLFQ boost epoch when last dispatched
+    vector<Instruction> program;    // compiled `screen -c` instructions
+    atomic<bool> isShutdown = false;    // set after shutdownReason/shutdownTime
+    string shutdownReason;
+    Timestamp shutdownTime;
+
+    // Interns a variable while the process runs; viewers may be reading names
+    uint16_t internVar(const string& varName) {
+        lock_guard<mutex> lock(varsMutex);
+        return vars.intern(varName);
+    }
+
+    string varName(uint16_t slot) const {
+        lock_guard<mutex> lock(varsMutex);
+        return slot < vars.names.size() ? vars.names[slot] : "?";
+    }
+};
+
+// Dense table of live processes. Slots live in fixed-size chunks that are
+// allocated on first use and never move, so resolving a handle is one chunk
+// load and one array index without a lock, and walking every process is a
+// linear scan. Removing a process bumps its slot's generation, so handles
+// still held by frames or queues are recognised as stale, and puts the slot
+// back on a free list for the next insert. The table therefore only fills
+// up with 2^24 processes live at once. The 8-bit generation wraps after 256
+// reuses of one slot, long after the frames and queues of a removed process
+// have dropped its handle. Pids come from a separate counter and are never
+// reused.
+class ProcessTable {
+public:
+    ~ProcessTable() {
+        for (auto& chunk : chunks) delete[] chunk.load();
+    }
+
+    // Gives `proc` the next pid and a slot, reusing a freed one first, and
+    // publishes it. Returns its handle, or NO_PROCESS if every slot is live.
+    ProcessHandle insert(Process* proc) {
+        uint32_t index;
+        {
+            lock_guard<mutex> lock(slotMutex);
+            if (!freeSlots.empty()) {
+                index = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            else if (nextIndex < HANDLE_INDEX_MASK) {
+                index = nextIndex++;
+            }
+            else {
+                return NO_PROCESS;
+            }
+        }
+
+        Slot& slot = slotAt(index, true);
+        proc->id = nextPid++;
+        proc->handle = (static_cast<uint32_t>(slot.generation.load()) << HANDLE_INDEX_BITS) | index;
+        slot.proc.store(proc, memory_order_release);
+        return proc->handle;
+    }
+
+    void remove(ProcessHandle handle) {
+        Slot* slot = find(handle);
+        if (!slot) return;
+        slot->proc.store(nullptr, memory_order_release);
+        slot->generation++;
+        lock_guard<mutex> lock(slotMutex);
+        freeSlots.push_back(handle & HANDLE_INDEX_MASK);
+    }
+
+    // nullptr if the handle is stale or was never issued
+    Process* get(ProcessHandle handle) const {
+        Slot* slot = find(handle);
+        return slot ? slot->proc.load(memory_order_acquire) : nullptr;
+    }
+
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        uint32_t end = min(nextIndex.load(), HANDLE_INDEX_MASK);
+        for (uint32_t index = 1; index < end; ++index) {
+            Slot* chunk = chunks[index >> CHUNK_BITS].load(memory_order_acquire);
+            if (!chunk) {
+                index |= CHUNK_SIZE - 1;   // skip the whole unallocated chunk
+                continue;
+            }
+            Process* proc = chunk[index & (CHUNK_SIZE - 1)].proc.load(memory_order_acquire);
+            if (proc) fn(proc);
+        }
+    }
+
+private:
+    struct Slot {
+        atomic<Process*> proc = nullptr;
+        atomic<uint8_t> generation = 0;
+    };
+
+    static constexpr uint32_t CHUNK_BITS = 12;
+    static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+    static constexpr uint32_t MAX_CHUNKS = (HANDLE_INDEX_MASK + 1) >> CHUNK_BITS;
+
+    Slot* find(ProcessHandle handle) const {
+        if (handle == NO_PROCESS) return nullptr;
+        uint32_t index = handle & HANDLE_INDEX_MASK;
+        Slot* chunk = chunks[index >> CHUNK_BITS].load(memory_order_acquire);
+        if (!chunk) return nullptr;
+        Slot& slot = chunk[index & (CHUNK_SIZE - 1)];
+        if (slot.generation.load() != (handle >> HANDLE_INDEX_BITS)) return nullptr;
+        return &slot;
+    }
+
+    Slot& slotAt(uint32_t index, bool create) {
+        atomic<Slot*>& chunkRef = chunks[index >> CHUNK_BITS];
+        Slot* chunk = chunkRef.load(memory_order_acquire);
+        if (!chunk && create) {
+            lock_guard<mutex> lock(growMutex);
+            chunk = chunkRef.load(memory_order_acquire);
+            if (!chunk) {
+                chunk = new Slot[CHUNK_SIZE];
+                chunkRef.store(chunk, memory_order_release);
+            }
+        }
+        return chunk[index & (CHUNK_SIZE - 1)];
+    }
+
+    atomic<Slot*> chunks[MAX_CHUNKS] = {};
+    mutex growMutex;                 // only taken to allocate a chunk
+    mutex slotMutex;                 // guards freeSlots and nextIndex
+    vector<uint32_t> freeSlots;      // removed slots, reused before new ones
+    atomic<uint32_t> nextIndex = 1;  // slot 0 is never issued
+    atomic<int> nextPid = 1;         // pid 0 is never issued
+};
+
+ProcessTable processTable;
+
+// What is kept of a process once it finishes or is shut down. The Process
+// itself is freed; screen -ls, report-util and screen -r read this instead.
+struct ProcessSummary {
+    int id = 0;
+    string name;
+    Timestamp created;
+    Timestamp finishedTime;
+    uint64_t totalLine = 0;
+    uint64_t memorySize = 0;
+    uint32_t migrations = 0;
+    int64_t waitNs = 0;
+    int64_t turnaroundNs = 0;
+    bool shutdown = false;
+    string shutdownReason;
+    Timestamp shutdownTime;
+};
+
+// Scheduler statistics kept up to date as processes change state, so
+// screen -ls, report-util and process-smi cost O(rows shown) and never walk
+// every process or page table. Only state changes take the list lock.
+class ProcessStats {
+public:
+    enum class List { FINISHED, SHUTDOWN };
+
+    // First dispatch onto a core
+    void started(Process* proc) {
+        lock_guard<mutex> lock(listMutex);
+        running.insert(proc);
+    }
+
+    // Finished or shut down: keeps a summary, after which `proc` may be freed
+    void retired(Process* proc) {
+        ProcessSummary summary;
+        summary.id = proc->id;
+        summary.name = proc->name;
+        summary.created = proc->timestamp;
+        summary.finishedTime = proc->finishedTime;
+        summary.totalLine = proc->totalLine;
+        summary.memorySize = proc->memorySize;
+        summary.migrations = proc->migrations;
+        summary.waitNs = proc->waitNs;
+        summary.turnaroundNs = proc->finishNs - proc->arrivalNs;
+        summary.shutdown = proc->isShutdown;
+        if (summary.shutdown) {
+            summary.shutdownReason = proc->shutdownReason;
+            summary.shutdownTime = proc->shutdownTime;
+        }
+
+        lock_guard<mutex> lock(listMutex);
+        running.erase(proc);
+        retiredLists[index(summary.shutdown ? List::SHUTDOWN : List::FINISHED)]
+            .emplace(summary.id, move(summary));
+    }
+
+    // Calls fn(const Process&) on each running process in pid order. The list
+    // lock is held throughout, so none of them can be retired and freed
+    // while fn reads it.
+    template <typename Fn>
+    void forEachRunning(Fn fn) const {
+        lock_guard<mutex> lock(listMutex);
+        for (const Process* proc : running) fn(*proc);
+    }
+
+    // Copy of one retired list in pid order
+    vector<ProcessSummary> list(List which) const {
+        lock_guard<mutex> lock(listMutex);
+        vector<ProcessSummary> out;
+        out.reserve(retiredLists[index(which)].size());
+        for (const auto& entry : retiredLists[index(which)]) out.push_back(entry.second);
+        return out;
+    }
+
+    // Summary of retired pid `id`; false if it has not retired
+    bool findRetired(int id, ProcessSummary& out) const {
+        lock_guard<mutex> lock(listMutex);
+        for (const auto& retired : retiredLists) {
+            auto it = retired.find(id);
+            if (it != retired.end()) {
+                out = it->second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Per-core occupancy: cores currently holding a process
+    void coreTaken() { busy++; }
+    void coreReleased() { busy--; }
+    void resetCores() { busy = 0; }
+    int busyCores() const { return busy.load(); }
+
+private:
+    struct PidOrder {
+        bool operator()(const Process* a, const Process* b) const { return a->id < b->id; }
+    };
+
+    static size_t index(List which) { return static_cast<size_t>(which); }
+
+    mutable mutex listMutex;
+    set<Process*, PidOrder> running;
+    map<int, ProcessSummary> retiredLists[2];   // by pid
+    atomic<int> busy = 0;
+};
+
+ProcessStats processStats;
+
+// Log-bucketed latency histogram in the style of HdrHistogram. Each power of
+// two is split into 16 linear sub-buckets, so any recorded value is known to
+// within about 6% across the full 64-bit nanosecond range in under 1000
+// counters. Recording is a relaxed increment and never takes a lock.
+class LatencyHistogram {
+public:
+    void record(uint64_t ns) {
+        counts[bucketOf(ns)].fetch_add(1, memory_order_relaxed);
+        total.fetch_add(1, memory_order_relaxed);
+        sumNs.fetch_add(ns, memory_order_relaxed);
+        uint64_t prevMax = maxNs.load(memory_order_relaxed);
+        while (ns > prevMax && !maxNs.compare_exchange_weak(prevMax, ns, memory_order_relaxed)) {}
+    }
+
+    void reset() {
+        for (auto& count : counts) count = 0;
+        total = 0;
+        sumNs = 0;
+        maxNs = 0;
+    }
+
+    uint64_t count() const { return total.load(); }
+    uint64_t maxValue() const { return maxNs.load(); }
+    double meanNs() const {
+        uint64_t n = total.load();
+        return n ? static_cast<double>(sumNs.load()) / n : 0.0;
+    }
+
+    // Value at `fraction` (0-1] of the recorded samples, as the midpoint of
+    // its bucket; 0 when empty
+    uint64_t percentile(double fraction) const {
+        uint64_t n = total.load();
+        if (n == 0) return 0;
+        uint64_t rank = max<uint64_t>(1, static_cast<uint64_t>(ceil(fraction * n)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i].load(memory_order_relaxed);
+            if (seen >= rank) return min(bucketMid(i), maxNs.load());
+        }
+        return maxNs.load();
+    }
+
+private:
+    static constexpr int SUB_BITS = 4;
+    static constexpr uint64_t SUB_COUNT = 1u << SUB_BITS;
+    static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    // Index of the highest set bit; v must be non-zero
+    static int highestBit(uint64_t v) {
+        int bit = 0;
+        while (v >>= 1) ++bit;
+        return bit;
+    }
+
+    // Values below 16 get a bucket each; above that, 16 per power of two
+    static size_t bucketOf(uint64_t ns) {
+        if (ns < SUB_COUNT) return static_cast<size_t>(ns);
+        int magnitude = highestBit(ns);
+        uint64_t sub = (ns >> (magnitude - SUB_BITS)) & (SUB_COUNT - 1);
+        return static_cast<size_t>((magnitude - SUB_BITS + 1) * SUB_COUNT + sub);
+    }
+
+    static uint64_t bucketMid(size_t index) {
+        if (index < SUB_COUNT) return index;
+        int magnitude = static_cast<int>(index / SUB_COUNT) + SUB_BITS - 1;
+        uint64_t sub = index % SUB_COUNT;
+        int shift = magnitude - SUB_BITS;
+        uint64_t low = (SUB_COUNT + sub) << shift;
+        return low + ((uint64_t(1) << shift) >> 1);
+    }
+
+    atomic<uint64_t> counts[BUCKETS] = {};
+    atomic<uint64_t> total = 0;
+    atomic<uint64_t> sumNs = 0;
+    atomic<uint64_t> maxNs = 0;
+};
+
+// Scheduling latency of every process that has left the system:
+// wait     - total time spent ready in a queue but not on a core
+// response - creation to first dispatch (recorded at first dispatch)
+// turnaround - creation to finish or shutdown
+struct LatencyStats {
+    LatencyHistogram wait;
+    LatencyHistogram response;
+    LatencyHistogram turnaround;
+
+    void reset() {
+        wait.reset();
+        response.reset();
+        turnaround.reset();
+    }
+
+    // p50/p90/p99, mean and max in milliseconds, for latency-stats and
+    // report-util
+    void print(ostream& out) const {
+        out << "[Scheduling Latency] (ms; " << turnaround.count() << " processes completed)\n";
+        out << left << setw(12) << "Metric" << setw(9) << "Count"
+            << setw(12) << "p50" << setw(12) << "p90" << setw(12) << "p99"
+            << setw(12) << "Mean" << "Max\n";
+        printRow(out, "Wait", wait);
+        printRow(out, "Response", response);
+        printRow(out, "Turnaround", turnaround);
+        out << right;
+    }
+
+private:
+    static void printRow(ostream& out, const char* label, const LatencyHistogram& h) {
+        auto ms = [](double ns) { return ns / 1e6; };
+        out << fixed << setprecision(3) << left << setw(12) << label << setw(9) << h.count()
+            << setw(12) << ms(static_cast<double>(h.percentile(0.50)))
+            << setw(12) << ms(static_cast<double>(h.percentile(0.90)))
+            << setw(12) << ms(static_cast<double>(h.percentile(0.99)))
+            << setw(12) << ms(h.meanNs())
+            << ms(static_cast<double>(h.maxValue())) << "\n";
+    }
+};
+
+LatencyStats latencyStats;
+
+// Fills a freshly assigned frame from the write-back queue or the backing
+// store, or zeroes it for a page that has never been paged out
+void pageIn(int frameIndex, int pid, int pageNumber) {
+    uint8_t* dst = frameData(frameIndex);
+    if (!writeback.takeIfPending(pid, pageNumber, dst)
+        && !backingStore.loadPage(pid, pageNumber, dst)) {
+        memset(dst, 0, GLOBAL_CONFIG.memPerFrame);
+    }
+}
+
+// Caller must hold proc->ptMutex
+bool ensurePageResident(Process* proc, int pageNumber) {
+    if (!proc || pageNumber < 0 || pageNumber >= static_cast<int>(proc->pageTable.size())) {
+        return false; // Invalid process or page number
+    }
+
+    PageTableEntry& entry = proc->pageTable[pageNumber];
+    if (entry.inMemory) {
+        pageReplacer.touch(entry.frameIndex);
+        return true; // Already in memory
+    }
+
+    int frame = -1;
+    int victimPageNum = -1;
+    Process* victimProc = nullptr;   // locked below unless it is `proc` itself
+    {
+        std::lock_guard<std::mutex> lock(replMutex);
+
+        // === Try to take a free frame ===
+        frame = frameAllocator.allocate();
+
+        // === No free frame: evict the page chosen by the replacement policy ===
+        // Owners are only try-locked; a busy owner's frame is skipped.
+        for (size_t attempt = 0; frame == -1 && attempt < physicalMemory.size(); ++attempt) {
+            int candidate = pageReplacer.victim();
+            if (candidate == -1) break;
+
+            // A stale handle means the owner is gone: reclaim without write-back
+            Process* owner = processTable.get(physicalMemory[candidate].owner);
+            if (owner && owner != proc && !owner->ptMutex.try_lock()) {
+                pageReplacer.requeue(candidate);
+                continue;
+            }
+
+            frame = candidate;
+            victimPageNum = physicalMemory[candidate].pageNumber;
+            victimProc = owner;
+        }
+        if (frame == -1) return false; // No free frame and nothing to evict
+
+        physicalMemory[frame].owner = proc->handle;
+        physicalMemory[frame].pageNumber = pageNumber;
+        pageReplacer.insert(frame);
+    }
+
+    if (victimProc) {
+        // Queue the victim's bytes before its owner can fault the page back in
+        writeback.enqueue(victimProc->id, victimPageNum, frameData(frame));
+        pageOutCount++;
+
+        // Invalidate evicted page
+        PageTableEntry& evictedEntry = victimProc->pageTable[victimPageNum];
+        evictedEntry.inMemory = false;
+        evictedEntry.frameIndex = -1;
+        victimProc->residentPages--;
+        if (victimProc != proc) victimProc->ptMutex.unlock();
+    }
+
+    // Load the new page into the frame
+    pageIn(frame, proc->id, pageNumber);
+    pageInCount++;
+    entry.inMemory = true;
+    entry.frameIndex = frame;
+    proc->residentPages++;
+
+    return true;
+}
+
+// Returns every resident page of `proc` to the free list.
+// Caller must hold proc->ptMutex.
+void releaseProcessFrames(Process* proc) {
+    std::lock_guard<std::mutex> lock(replMutex);
+    for (PageTableEntry& e : proc->pageTable) {
+        if (!e.inMemory) continue;
+        // A frame that is not allocated was never this process's to free
+        if (frameAllocator.release(e.frameIndex)) {
+            pageReplacer.remove(e.frameIndex);
+            physicalMemory[e.frameIndex].owner = NO_PROCESS;
+            physicalMemory[e.frameIndex].pageNumber = -1;
+        }
+        e.inMemory = false;
+        e.frameIndex = -1;
+    }
+    proc->residentPages = 0;
+}
+
+bool loadPageIfNotInMemory(Process* proc, int pageNumber) {
+    std::lock_guard<std::mutex> lock(proc->ptMutex);
+    return ensurePageResident(proc, pageNumber);
+}
+
+// Reads the little-endian word at `address` through the page table. A byte
+// past the end of the address space reads as 0. Returns false if a page could
+// not be made resident.
+bool readWord(Process* proc, uint64_t address, uint16_t& value) {
+    std::lock_guard<std::mutex> lock(proc->ptMutex);
+    uint8_t bytes[2] = { 0, 0 };
+    for (uint64_t i = 0; i < 2 && address + i < proc->memorySize; ++i) {
+        int page = static_cast<int>((address + i) / GLOBAL_CONFIG.memPerFrame);
+        if (!ensurePageResident(proc, page)) return false;
+        bytes[i] = frameData(proc->pageTable[page].frameIndex)[(address + i) % GLOBAL_CONFIG.memPerFrame];
+    }
+    value = static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+    return true;
+}
+
+bool writeWord(Process* proc, uint64_t address, uint16_t value) {
+    std::lock_guard<std::mutex> lock(proc->ptMutex);
+    const uint8_t bytes[2] = { static_cast<uint8_t>(value & 0xFF), static_cast<uint8_t>(value >> 8) };
+    for (uint64_t i = 0; i < 2 && address + i < proc->memorySize; ++i) {
+        int page = static_cast<int>((address + i) / GLOBAL_CONFIG.memPerFrame);
+        if (!ensurePageResident(proc, page)) return false;
+        frameData(proc->pageTable[page].frameIndex)[(address + i) % GLOBAL_CONFIG.memPerFrame] = bytes[i];
+    }
+    return true;
+}
+
+// Assigns a variable and writes it through to the process' symbol table in
+// page 0. Returns false if page 0 could not be made resident.
+bool storeVar(Process* proc, uint16_t slot, uint16_t value) {
+    proc->vars.values[slot] = value;
+    if (slot * 2ULL >= SYMBOL_TABLE_BYTES) return true;
+    return writeWord(proc, slot * 2ULL, value);
+}
+
+
+
+void printHeader() {
+    cout << " _____  _____   ____  _____  ______  _______     __" << endl;
+    cout << "/ ____|/ ____| / __ \\|  __ \\|  ____|/ ____\\ \\   / /" << endl;
+    cout << "| |    | (___ | |  | | |__) | |__  | (___  \\ \\_/ /" << endl;
+    cout << "| |     \\___ \\| |  | |  ___/|  __|  \\___ \\  \\   /" << endl;
+    cout << "| |____ ____) | |__| | |    | |____ ____) |  | |" << endl;
+    cout << " \\_____|_____/ \\____/|_|    |______|_____/   |_|" << endl;
+    cout << "\033[32m";
+    cout << "Hello, Welcome to CSOPESY command line!" << endl;
+    cout << "\033[33m";
+    cout << "Type 'exit' to quit, 'clear' to clear the screen" << endl;
+    cout << "\033[0m";
+}
+
+void clearScreen() {
+    cout << "\033[2J\033[1;1H";
+}
+
+string formatTimestamp(time_t now) {
+    tm localTime;
+#ifdef _WIN32   
+    localtime_s(&localTime, &now); // Windows
+#else
+    localtime_r(&now, &localTime); // POSIX (macOS, Linux)
+#endif
+    stringstream ss;
+    ss << put_time(&localTime, "%m/%d/%Y %I:%M:%S%p");
+    return ss.str();
+}
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** generator. Unlike mt19937 plus the std:: distributions it is
+// a few instructions per draw and yields the same sequence on every compiler
+// and standard library, so a seeded run replays exactly.
+class Xoshiro256 {
+public:
+    explicit Xoshiro256(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        for (uint64_t& word : s) word = splitmix64(seed);
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Uniform in [lo, hi]; the modulo bias is negligible for these ranges
+    uint64_t between(uint64_t lo, uint64_t hi) {
+        uint64_t span = hi - lo + 1;
+        return span == 0 ? next() : lo + next() % span;
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t s[4];
+};
+
+// All emulator randomness, derived from one seed: a stream per core for
+// instruction generation, one for process creation and one for batch
+// arrival times. With a fixed `seed`
+// and --virtual-time a run is reproducible bit for bit.
+class RngService {
+public:
+    // The configured seed, or a fresh one for seed 0. Report it so the run
+    // can be replayed.
+    static uint64_t resolveSeed(uint64_t configured) {
+        if (configured != 0) return configured;
+        random_device rd;
+        return (static_cast<uint64_t>(rd()) << 32) | rd();
+    }
+
+    // Only call while no core is drawing from its stream
+    void reset(uint64_t seed, int numCores) {
+        uint64_t state = seed;
+        {
+            lock_guard<mutex> lock(creationMutex);
+            creationStream.reseed(splitmix64(state));
+        }
+        cores.assign(max(numCores, 1), CoreStream());
+        for (CoreStream& core : cores) core.rng.reseed(splitmix64(state));
+        arrivalStream.reseed(splitmix64(state));
+    }
+
+    // Only ever used by the thread running `coreId`
+    Xoshiro256& core(int coreId) { return cores[coreId - 1].rng; }
+
+    // Process creation happens on the shell and batch threads
+    uint64_t creationBetween(uint64_t lo, uint64_t hi) {
+        lock_guard<mutex> lock(creationMutex);
+        return creationStream.between(lo, hi);
+    }
+
+    // Batch arrival gaps; only ever used by the batch generator
+    Xoshiro256& arrivals() { return arrivalStream; }
+
+private:
+    struct alignas(64) CoreStream {
+        Xoshiro256 rng;
+    };
+
+    vector<CoreStream> cores;
+    mutex creationMutex;
+    Xoshiro256 creationStream;
+    Xoshiro256 arrivalStream;
+};
+
+RngService rngService;
+
+uint64_t cpuBurstGenerator() {
+    return rngService.creationBetween(GLOBAL_CONFIG.minInstructions, GLOBAL_CONFIG.maxInstructions);
+}
+
+uint64_t generateRandomMemSize() {
+    static const vector<uint64_t> pow2 = {
+        64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536
+    };
+
+    vector<uint64_t> filtered;
+    for (uint64_t val : pow2) {
+        if (val >= GLOBAL_CONFIG.minMemPerProc && val <= GLOBAL_CONFIG.maxMemPerProc) {
+            filtered.push_back(val);
+        }
+    }
+
+    if (filtered.empty()) {
+        throw runtime_error("No valid power-of-2 memory size within range.");
+    }
+
+    return filtered[rngService.creationBetween(0, filtered.size() - 1)];
+}
+
+uint64_t generateRandomDataAddress(Xoshiro256& rng, uint64_t minAddr, uint64_t maxAddr) {
+    return rng.between(minAddr, maxAddr);
+}
+
+string formatHexAddress(uint64_t address) {
+    stringstream ss;
+    ss << "0x" << hex << address;
+    return ss.str();
+}
+
+// Discrete-event queue for --virtual-time. Events are ordered by cycle, then
+// by posting order, so a run is deterministic for a given command sequence.
+class EventSimulator {
+public:
+    enum class Kind { CoreStep, BatchArrival };
+
+    struct Event {
+        uint64_t cycle;
+        uint64_t seq;
+        Kind kind;
+        int coreId;
+        int epoch;              // batch generation that posted a BatchArrival
+
+        bool operator>(const Event& other) const {
+            return cycle != other.cycle ? cycle > other.cycle : seq > other.seq;
+        }
+    };
+
+    void reset() {
+        events = {};
+        stallCycles = 0;
+        batching = false;
+        ++batchEpoch;
+    }
+
+    uint64_t now() const { return cycle; }
+
+    void post(uint64_t at, Kind kind, int coreId = 0) {
+        events.push({ at, nextSeq++, kind, coreId, batchEpoch });
+    }
+
+    bool empty() const { return events.empty(); }
+
+    // Pops the next event due at or before `until`, advancing the clock to
+    // it. Batch arrivals of a stopped generator are dropped without moving
+    // the clock.
+    bool next(uint64_t until, Event& out) {
+        while (!events.empty() && events.top().kind == Kind::BatchArrival
+            && !isCurrentBatch(events.top())) {
+            events.pop();
+        }
+        if (events.empty() || events.top().cycle > until) return false;
+        out = events.top();
+        events.pop();
+        cycle = out.cycle;
+        return true;
+    }
+
+    void advanceTo(uint64_t at) { cycle = max<uint64_t>(cycle, at); }
+
+    // Extra cycles charged to the instruction currently executing (SLEEP)
+    void addStall(uint64_t cycles) { stallCycles += cycles; }
+    uint64_t takeStall() {
+        uint64_t stall = stallCycles;
+        stallCycles = 0;
+        return stall;
+    }
+
+    void startBatches() {
+        batching = true;
+        ++batchEpoch;
+    }
+    // Also purges the pending arrival, so it neither moves the clock nor
+    // keeps `run` from going idle
+    void stopBatches() {
+        batching = false;
+        vector<Event> kept;
+        while (!events.empty()) {
+            if (events.top().kind != Kind::BatchArrival) kept.push_back(events.top());
+            events.pop();
+        }
+        for (const Event& e : kept) events.push(e);
+    }
+    bool batchesActive() const { return batching; }
+    bool isCurrentBatch(const Event& e) const { return batching && e.epoch == batchEpoch; }
+
+private:
+    priority_queue<Event, vector<Event>, greater<Event>> events;
+    atomic<uint64_t> cycle = 0;
+    uint64_t nextSeq = 0;
+    uint64_t stallCycles = 0;
+    bool batching = false;
+    int batchEpoch = 0;
+};
+
+EventSimulator simulator;
+
+// Sleeps on the active clock: wall time normally, simulated cycles under
+// --virtual-time (charged to the running instruction)
+void simSleep(uint64_t ms) {
+    if (virtualTimeMode) {
+        simulator.addStall(ms);
+    }
+    else {
+        this_thread::sleep_for(chrono::milliseconds(ms));
+    }
+}
+
+// Wall-clock and monotonic time for the emulator. The formatted timestamp is
+// rebuilt at most once per (real or virtual) second and published through a
+// seqlock, so workers copy it without taking a lock or allocating.
+class ClockService {
+public:
+    ClockService()
+        : startEpoch(static_cast<int64_t>(time(nullptr))),
+        startSteady(chrono::steady_clock::now()) {
+    }
+
+    // Seconds since the epoch; under --virtual-time the clock starts when the
+    // emulator did and advances one second per 1000 cycles
+    int64_t wallSeconds() const {
+        if (virtualTimeMode) return startEpoch + static_cast<int64_t>(simulator.now() / 1000);
+        return static_cast<int64_t>(time(nullptr));
+    }
+
+    // Monotonic nanoseconds since startup, for latency measurements
+    int64_t monotonicNs() const {
+        if (virtualTimeMode) return static_cast<int64_t>(simulator.now()) * 1000000;
+        return chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - startSteady).count();
+    }
+
+    Timestamp now() {
+        int64_t second = wallSeconds();
+        while (true) {
+            uint64_t before = seq.load(memory_order_acquire);
+            if (before & 1) {
+                this_thread::yield();   // a refresh is being published
+                continue;
+            }
+            if (cachedSecond.load(memory_order_relaxed) < second) {
+                publish(second, before);
+                continue;
+            }
+
+            uint64_t packed[WORDS];
+            for (size_t i = 0; i < WORDS; ++i) packed[i] = words[i].load(memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (seq.load(memory_order_relaxed) != before) continue;
+
+            Timestamp out;
+            memcpy(out.text, packed, sizeof(out.text));
+            return out;
+        }
+    }
+
+private:
+    static constexpr size_t WORDS = sizeof(Timestamp::text) / sizeof(uint64_t);
+
+    // Formats and publishes `second`; a thread losing the race just retries
+    // its read and picks up the winner's text
+    void publish(int64_t second, uint64_t expected) {
+        if (!seq.compare_exchange_strong(expected, expected + 1, memory_order_acquire)) return;
+        atomic_thread_fence(memory_order_release);
+
+        string text = formatTimestamp(static_cast<time_t>(second));
+        uint64_t packed[WORDS] = {};
+        memcpy(packed, text.data(), min(text.size(), sizeof(packed) - 1));
+        for (size_t i = 0; i < WORDS; ++i) words[i].store(packed[i], memory_order_relaxed);
+        cachedSecond.store(second, memory_order_relaxed);
+
+        seq.store(expected + 2, memory_order_release);
+    }
+
+    const int64_t startEpoch;
+    const chrono::steady_clock::time_point startSteady;
+    atomic<uint64_t> seq = 0;                 // odd while a refresh is in progress
+    atomic<int64_t> cachedSecond = -1;
+    atomic<uint64_t> words[WORDS] = {};       // packed timestamp text
+};
+
+ClockService clockService;
+
+Timestamp generateTimestamp() {
+    return clockService.now();
+}
+
+void instructions_manager(
+    uint64_t currentLine,
+    InstructionLog& instructions,
+    SymbolTable& vars,
+    const string& processName,
+    int coreId,
+    Process* proc
+) {
+    // 0) If already shutdown, do nothing
+    if (proc->isShutdown) return;
+
+    // 1) Common record header; the text is only built when someone views it
+    LogRecord rec;
+    rec.wallTime = clockService.wallSeconds();
+    rec.line = currentLine;
+    rec.core = static_cast<uint16_t>(coreId);
+
+    // 2) If we still have compiled custom instructions queued, run those first:
+    if (currentLine < proc->program.size()) {
+        const Instruction& ins = proc->program[currentLine];
+        vector<uint16_t>& val = vars.values;
+        rec.flags = LOG_CUSTOM;
+
+        switch (ins.op) {
+        // --- DECLARE <var> <value> ---
+        case OpCode::DECLARE: {
+            storeVar(proc, ins.dst, ins.imm);
+            rec.op = LogOp::DECLARE;
+            rec.dst = ins.dst;
+            rec.result = ins.imm;
+            break;
+        }
+
+        // --- ADD <dst> <a> <b> ---
+        case OpCode::ADD: {
+            rec.op = LogOp::ADD;
+            rec.a = ins.a;
+            rec.b = ins.b;
+            rec.valA = val[ins.a];
+            rec.valB = val[ins.b];
+            rec.result = clampUint16(rec.valA + rec.valB);
+            storeVar(proc, ins.dst, rec.result);
+            break;
+        }
+
+        // --- SUBTRACT <dst> <a> <b> ---
+        case OpCode::SUBTRACT: {
+            rec.op = LogOp::SUBTRACT;
+            rec.a = ins.a;
+            rec.b = ins.b;
+            rec.valA = val[ins.a];
+            rec.valB = val[ins.b];
+            rec.result = clampUint16(rec.valA - rec.valB);
+            storeVar(proc, ins.dst, rec.result);
+            break;
+        }
+
+        // --- WRITE 0xHEXADDR <value|var> ---
+        case OpCode::WRITE: {
+            // --- bounds check ---
+            if (ins.address < 64 || ins.address >= proc->memorySize) {
+                proc->shutdownReason = "Memory access violation at " + formatHexAddress(ins.address);
+                proc->shutdownTime = generateTimestamp();
+                proc->isShutdown = true;
+                rec.op = LogOp::VIOLATION;
+                rec.address = ins.address;
+                instructions.append(rec);
+                return;
+            }
+
+            rec.op = LogOp::WRITE;
+            rec.address = ins.address;
+            rec.result = ins.srcIsImm ? ins.imm : val[ins.b];
+            writeWord(proc, ins.address, rec.result);
+            break;
         }
 
         // --- READ <var> 0xHEXADDR ---
-        else if (regex_match(instr, m, regex(R"(READ\s+([A-Za-z_]\w*)\s+(0x[0-9A-Fa-f]+))"))) {
-            string var = m[1];
-            string addrHex = m[2];
-            uint64_t address = stoull(addrHex, nullptr, 16);
+        case OpCode::READ: {
+            // --- bounds check ---
+            if (ins.address < 64 || ins.address >= proc->memorySize) {
+                proc->shutdownReason = "Memory access violation at " + formatHexAddress(ins.address);
+                proc->shutdownTime = generateTimestamp();
+                proc->isShutdown = true;
+                rec.op = LogOp::VIOLATION;
+                rec.address = ins.address;
+                instructions.append(rec);
+                return;
+            }
+
+            uint16_t value = 0;
+            if (readWord(proc, ins.address, value)) rec.flags |= LOG_PAGE_LOADED;
+            storeVar(proc, ins.dst, value);
+            rec.op = LogOp::READ;
+            rec.dst = ins.dst;
+            rec.address = ins.address;
+            rec.result = value;
+            break;
+        }
+
+        // --- PRINT("Result: " + var) ---
+        case OpCode::PRINT: {
+            rec.op = LogOp::PRINT;
+            rec.a = ins.a;
+            rec.result = val[ins.a];
+            break;
+        }
+        }
+
+        // commit log and return
+        instructions.append(rec);
+        return;
+    }
+
+    // Random instruction generation, from this core's stream
+    Xoshiro256& gen = rngService.core(coreId);
+    auto valDistrib = [](Xoshiro256& rng) { return static_cast<uint16_t>(rng.between(1, 100)); };
+
+    int cmd = static_cast<int>(gen.between(0, 6));
+
+    // Declared vars live in the process' own symbol table
+    static constexpr size_t MAX_DECLARED_VARS = 32;
+    vector<uint16_t>& val = vars.values;
+
+
+    if (cmd == 1 || vars.empty()) {
+        // DECLARE
+        uint16_t value = valDistrib(gen);
+
+        if (vars.size() < MAX_DECLARED_VARS) {
+            uint16_t slot = proc->internVar("v" + to_string(vars.size()));
+            if (!storeVar(proc, slot, value)) rec.flags |= LOG_PAGE0_WARNING;
+            rec.op = LogOp::DECLARE;
+            rec.dst = slot;
+            rec.result = value;
+        }
+        else {
+            // — we've hit the 32‐var limit: ignore further DECLAREs —
+            rec.op = LogOp::DECLARE_IGNORED;
+            // (do *not* touch page 0 or the symbol table)
+        }
+    }
+    else if (cmd == 0 && !vars.empty()) {
+        // PRINT
+        if (!loadPageIfNotInMemory(proc, 0)) rec.flags |= LOG_PAGE0_WARNING;
+
+        rec.op = LogOp::PRINT;
+        rec.a = static_cast<uint16_t>(gen.next() % vars.size());
+        rec.result = val[rec.a];
+    }
+    else if ((cmd == 2 || cmd == 3) && vars.size() >= 2) {
+        // ADD / SUBTRACT: the result lands in a declared var instead of a fresh "resN" key
+        rec.op = cmd == 2 ? LogOp::ADD : LogOp::SUBTRACT;
+        rec.a = static_cast<uint16_t>(gen.next() % vars.size());
+        rec.b = static_cast<uint16_t>(gen.next() % vars.size());
+        uint16_t dst = static_cast<uint16_t>(gen.next() % vars.size());
+        rec.valA = val[rec.a];
+        rec.valB = val[rec.b];
+        rec.result = cmd == 2 ? clampUint16(rec.valA + rec.valB) : clampUint16(rec.valA - rec.valB);
+        if (!storeVar(proc, dst, rec.result)) rec.flags |= LOG_PAGE0_WARNING;
+    }
+    else if (cmd == 4) {
+        // SLEEP
+        int ms = 100;
+        simSleep(ms);
+        rec.op = LogOp::SLEEP;
+        rec.result = static_cast<uint16_t>(ms);
+    }
+    else if (cmd == 5) {
+        // READ
+        if (!vars.empty()) {
+            // 1) Pick a target variable
+            uint16_t slot = static_cast<uint16_t>(gen.next() % vars.size());
+
+            // 2) Pick a random address
+            uint64_t minAddr = GLOBAL_CONFIG.memPerFrame;  // skip page 0
+            uint64_t maxAddr = proc->memorySize - 1;
+            if (maxAddr < minAddr) maxAddr = minAddr;
+            uint64_t address = generateRandomDataAddress(gen, minAddr, maxAddr);
+            size_t   rawPage = address / GLOBAL_CONFIG.memPerFrame;
+            size_t   lastPage = proc->pageTable.size() - 1;
+
+            // 3) Read through the page table, faulting the page in if needed
+            uint16_t readValue = 0;
+            if (readWord(proc, address, readValue)) rec.flags |= LOG_PAGE_LOADED;
+            storeVar(proc, slot, readValue);
+
+            rec.op = LogOp::READ;
+            rec.dst = slot;
+            rec.address = address;
+            rec.page = static_cast<uint32_t>(std::min(rawPage, lastPage));
+            rec.result = readValue;
+        }
+    }
+
+    else if (cmd == 6) {
+        // WRITE
+        uint64_t minAddr = GLOBAL_CONFIG.memPerFrame;         // skip page 0
+        uint64_t maxAddr = proc->memorySize - 1;
+        if (maxAddr < minAddr) maxAddr = minAddr;
+        uint64_t address = generateRandomDataAddress(gen, minAddr, maxAddr);
+        size_t   rawPage = address / GLOBAL_CONFIG.memPerFrame;
+        size_t   lastPage = proc->pageTable.size() - 1;
+        uint16_t value = valDistrib(gen);
+
+        // Write through the page table, faulting the page in if needed
+        if (writeWord(proc, address, value)) rec.flags |= LOG_PAGE_LOADED;
+
+        rec.op = LogOp::WRITE;
+        rec.address = address;
+        rec.page = static_cast<uint32_t>(std::min(rawPage, lastPage));
+        rec.result = value;
+    }
+
+    else {
+        // FOR
+        if (vars.empty()) {
+            storeVar(proc, proc->internVar("v0"), valDistrib(gen));
+        }
+
+        uint16_t slot = static_cast<uint16_t>(gen.next() % vars.size());
+        uint16_t counter = val[slot];
+        int count = 3;
+
+        rec.op = LogOp::FOR;
+        rec.a = slot;
+        rec.valA = counter;
+        rec.valB = static_cast<uint16_t>(count);
+        counter = static_cast<uint16_t>(counter + count);
+        rec.result = counter;
+        storeVar(proc, slot, counter);
+    }
+
+    // Save result in instruction log
+    instructions.append(rec);
+}
+
+// Renders a log record as the text `process-smi` has always shown
+string formatLogRecord(const Process& proc, const LogRecord& rec) {
+    stringstream log;
+    log << "(" << formatTimestamp(rec.wallTime) << ") Core: " << rec.core << " \"";
+
+    if (rec.flags & LOG_PAGE0_WARNING) {
+        log << "WARNING: Page 0 not loaded; DECLARE attempted without memory.";
+    }
+
+    bool custom = (rec.flags & LOG_CUSTOM) != 0;
+    bool loaded = (rec.flags & LOG_PAGE_LOADED) != 0;
+    switch (rec.op) {
+    case LogOp::DECLARE:
+        log << "DECLARE " << proc.varName(rec.dst) << " = " << rec.result;
+        break;
+    case LogOp::DECLARE_IGNORED:
+        log << "DECLARE ignored";
+        break;
+    case LogOp::ADD:
+    case LogOp::SUBTRACT:
+        log << (rec.op == LogOp::ADD ? "ADD " : "SUBTRACT ")
+            << proc.varName(rec.a) << "(" << rec.valA << ")"
+            << (rec.op == LogOp::ADD ? " + " : " - ")
+            << proc.varName(rec.b) << "(" << rec.valB << ") = " << rec.result;
+        break;
+    case LogOp::WRITE:
+        log << "WRITE " << formatHexAddress(rec.address) << " " << rec.result;
+        if (!custom) {
+            log << " (Page " << rec.page << (loaded ? " loaded)" : " not loaded - memory full)");
+        }
+        break;
+    case LogOp::READ:
+        log << "READ " << proc.varName(rec.dst) << " = " << rec.result
+            << " from " << formatHexAddress(rec.address);
+        if (custom) {
+            log << (loaded ? " (loaded)" : " (not loaded)");
+        }
+        else {
+            log << " (Page " << rec.page << (loaded ? " loaded)" : " not loaded - memory full)");
+        }
+        break;
+    case LogOp::PRINT:
+        if (custom) {
+            log << "PRINT(\"Result: \" + " << proc.varName(rec.a) << ") = " << rec.result;
+        }
+        else {
+            log << "PRINT " << proc.varName(rec.a) << " = " << rec.result;
+        }
+        break;
+    case LogOp::SLEEP:
+        log << "SLEPT for " << rec.result << "ms";
+        break;
+    case LogOp::FOR:
+        log << "FOR loop on " << proc.varName(rec.a) << ": ";
+        for (uint16_t i = 0; i < rec.valB; ++i) {
+            log << "[" << i + 1 << "]=" << static_cast<uint16_t>(rec.valA + i + 1) << " ";
+        }
+        break;
+    case LogOp::VIOLATION:
+        log << "Memory access violation at " << formatHexAddress(rec.address);
+        break;
+    }
+
+    log << "\"";
+    return log.str();
+}
+
+// screen -r on a process that has already finished or been shut down
+void printRetiredProcess(const ProcessSummary& proc) {
+    if (proc.shutdown) {
+        cout << "Process " << proc.name
+            << " shutdown due to memory access violation error that occurred at "
+            << proc.shutdownTime << ". "
+            << proc.shutdownReason << " invalid."
+            << endl;
+        return;
+    }
+    cout << "Process " << proc.name << " (ID " << proc.id << ") finished at "
+        << proc.finishedTime << ": " << proc.totalLine << " / " << proc.totalLine
+        << " instructions." << endl;
+    cout << "Created: " << proc.created << endl;
+    cout << "Memory Size: " << proc.memorySize << " bytes" << endl;
+    cout << "Migrations: " << proc.migrations << endl;
+    cout << fixed << setprecision(3)
+        << "Wait: " << proc.waitNs / 1e6 << " ms, turnaround: "
+        << proc.turnaroundNs / 1e6 << " ms" << endl;
+    cout.unsetf(ios::fixed);
+}
+
+void printProcessDetails(const Process& proc) {
+    // If the process was shutdown, show the violation message and return
+    if (proc.isShutdown) {
+        cout << "Process " << proc.name
+            << " shutdown due to memory access violation error that occurred at "
+            << proc.shutdownTime << ". "
+            << proc.shutdownReason << " invalid."
+            << endl;
+        return;
+    }
+
+    // Otherwise, show the normal details
+    cout << "Process: " << proc.name << endl;
+    cout << "ID: " << proc.id << endl;
+    cout << "Memory Size: " << proc.memorySize << " bytes" << endl;
+    cout << "Instruction: " << proc.currentLine << " of " << proc.totalLine << endl;
+    cout << "Created: " << proc.timestamp << endl;
+
+    std::lock_guard<std::mutex> lock(proc.ptMutex);
+    cout << "Page Table (" << proc.pageTable.size() << " pages):\n";
+    for (size_t i = 0; i < proc.pageTable.size(); ++i) {
+        cout << "  Page " << i
+            << ": inMemory=" << boolalpha << proc.pageTable[i].inMemory
+            << ", frameIndex=" << proc.pageTable[i].frameIndex
+            << endl;
+    }
+
+    cout << "\033[33m";
+    cout << "Type 'exit' to quit, 'clear' to clear the screen" << endl;
+    cout << "\033[0m";
+}
+
+
+const uint64_t LOG_PAGE_SIZE = 20;
+
+// Prints one page of the process log: `pageArg` is a 1-based page number,
+// oldest first, or empty for the newest page
+void printLogPage(const Process& proc, const string& pageArg) {
+    uint64_t first = proc.instructions.firstAvailable();
+    uint64_t total = proc.instructions.size();
+    uint64_t available = total - first;
+    uint64_t pages = max<uint64_t>((available + LOG_PAGE_SIZE - 1) / LOG_PAGE_SIZE, 1);
+
+    uint64_t page = pages;
+    if (!pageArg.empty()) {
+        try {
+            page = stoull(pageArg);
+        }
+        catch (...) {
+            page = 0;
+        }
+        if (page < 1 || page > pages) {
+            cout << "Invalid page. Use process-smi <1-" << pages << ">." << endl;
+            return;
+        }
+    }
+
+    vector<LogRecord> entries;
+    uint64_t from = first + (page - 1) * LOG_PAGE_SIZE;
+    proc.instructions.read(from, LOG_PAGE_SIZE, entries);
+    for (const LogRecord& entry : entries) {
+        cout << "  - " << formatLogRecord(proc, entry) << endl;
+    }
+
+    cout << "Log page " << page << " of " << pages << " (entries " << from + 1 << "-"
+        << from + entries.size() << " of " << total << ")";
+    if (first > 0) cout << ", " << first << " older entries dropped";
+    cout << endl;
+}
+
+void displayProcess(const Process& proc) {
+    printProcessDetails(proc);
+    string subCommand;
+    while (true) {
+        cout << "Enter a command: ";
+        getline(cin, subCommand);
+        if (subCommand == "exit") break;
+        else if (subCommand == "clear") {
+            clearScreen();
+            printProcessDetails(proc);
+        }
+        else if (subCommand == "process-smi" || subCommand.rfind("process-smi ", 0) == 0) {
+            cout << "\nprocess_name: " << proc.name << endl;
+            cout << "ID: " << proc.id << endl;
+            cout << "Logs:\n(" << proc.timestamp << ") Core: " << proc.coreAssigned << endl;
+            cout << "Migrations: " << proc.migrations << endl;
+            cout << "\nCurrent instruction line " << proc.currentLine << endl;
+            cout << "Lines of code: " << proc.totalLine << endl;
+            // Print only finished instructions
+            if (!proc.isFinished) {
+                printLogPage(proc, subCommand.size() > 12 ? subCommand.substr(12) : "");
+            }
+            else {
+                cout << "\nStatus: finished\n";
+            }
+            cout << endl;
+        }
+        else {
+            cout << "Unknown command inside process view." << endl;
+        }
+    }
+}
+
+// Per-level ready queue depths; defined with the schedulers below
+void printSchedulerQueues(ostream& out);
+
+// Per-core counters and utilization history; defined with cpuWorker below
+void printCoreUtilization(ostream& out, size_t samples);
+
+class ProcessManager {
+private:
+    // Split by name hash with a lock each, so creating a process only blocks
+    // lookups that land in the same shard
+    static constexpr size_t NAME_SHARDS = 16;
+
+    // Owns the live processes, keyed by name; processTable is the pid index.
+    // A retired process leaves byName but keeps its name taken through
+    // retiredIds, whose pid finds its summary in processStats. The shell
+    // holds its own reference while it shows a process.
+    struct alignas(64) NameShard {
+        mutable shared_mutex lock;
+        unordered_map<string, shared_ptr<Process>> byName;
+        unordered_map<string, int> retiredIds;
+    };
+
+    NameShard shards[NAME_SHARDS];
+
+    enum class InsertResult { INSERTED, NAME_TAKEN, TABLE_FULL };
+
+    static string batchName(uint64_t n) {
+        return "process" + (n < 10 ? "0" + to_string(n) : to_string(n));
+    }
+
+    // A fresh process with random length and memory, not yet registered
+    static shared_ptr<Process> buildProcess(const string& name) {
+        uint64_t memSize = generateRandomMemSize();
+        auto proc = make_shared<Process>();
+        proc->name = name;
+        proc->totalLine = cpuBurstGenerator();
+        proc->timestamp = generateTimestamp();
+        proc->arrivalNs = clockService.monotonicNs();
+        proc->readyNs = proc->arrivalNs;
+        proc->memorySize = memSize;
+        proc->pageTable.resize(memSize / GLOBAL_CONFIG.memPerFrame);
+        return proc;
+    }
+
+    // Registers `proc` under its name and gives it a pid; the manager shares
+    // ownership only on success
+    InsertResult insertProcess(const shared_ptr<Process>& proc) {
+        NameShard& shard = shardFor(proc->name);
+        lock_guard<shared_mutex> lock(shard.lock);
+        if (shard.byName.count(proc->name) || shard.retiredIds.count(proc->name)) {
+            return InsertResult::NAME_TAKEN;
+        }
+        if (processTable.insert(proc.get()) == NO_PROCESS) return InsertResult::TABLE_FULL;
+        proc->instructions.configure(GLOBAL_CONFIG.logCapacity, GLOBAL_CONFIG.logSpill
+            ? LOG_SEGMENT_DIR + "/process-" + to_string(proc->id) + ".rec" : "");
+        shard.byName.emplace(proc->name, proc);
+        return InsertResult::INSERTED;
+    }
+
+    NameShard& shardFor(const string& name) {
+        return shards[hash<string>{}(name) % NAME_SHARDS];
+    }
+
+public:
+    // Returns the new process, or nullptr if the name is already taken
+    shared_ptr<Process> createProcess(const string& name) {
+        // Build outside the shard lock; only the insert is serialized
+        shared_ptr<Process> proc = buildProcess(name);
+        switch (insertProcess(proc)) {
+        case InsertResult::NAME_TAKEN:
+            cout << "Process " << name << " already exists." << endl;
+            return nullptr;
+        case InsertResult::TABLE_FULL:
+            cout << "Process table full; cannot create " << name << "." << endl;
+            return nullptr;
+        default:
+            return proc;
+        }
+    }
+
+    // Creates up to `count` batch processes named processNN, numbered from
+    // `nameCounter` on. Every process is built before any shard lock is
+    // taken; a name already in use is skipped by renaming to the next one.
+    vector<Process*> createBatch(size_t count, uint64_t& nameCounter) {
+        vector<shared_ptr<Process>> built;
+        built.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            built.push_back(buildProcess(batchName(nameCounter++)));
+        }
+
+        vector<Process*> created;
+        created.reserve(count);
+        for (const shared_ptr<Process>& proc : built) {
+            Process* raw = proc.get();
+            InsertResult result;
+            while ((result = insertProcess(proc)) == InsertResult::NAME_TAKEN) {
+                raw->name = batchName(nameCounter++);
+            }
+            if (result == InsertResult::TABLE_FULL) {
+                cout << "Process table full; batch cut to " << created.size() << " processes." << endl;
+                break;
+            }
+            created.push_back(raw);
+        }
+        return created;
+    }
+
+    // The live process named `name`, or nullptr if there is none
+    shared_ptr<Process> retrieveProcess(const string& name) {
+        NameShard& shard = shardFor(name);
+        shared_lock<shared_mutex> lock(shard.lock);
+        auto it = shard.byName.find(name);
+        return it != shard.byName.end() ? it->second : nullptr;
+    }
+
+    // Summary of the retired process named `name`; false if there is none
+    bool retrieveRetired(const string& name, ProcessSummary& out) {
+        int id;
+        {
+            NameShard& shard = shardFor(name);
+            shared_lock<shared_mutex> lock(shard.lock);
+            auto it = shard.retiredIds.find(name);
+            if (it == shard.retiredIds.end()) return false;
+            id = it->second;
+        }
+        return processStats.findRetired(id, out);
+    }
+
+    // Drops the manager's reference to a retired process and frees its pid
+    // slot. Its name stays taken. The Process is freed here unless the shell
+    // is still showing it.
+    void release(Process* proc) {
+        processTable.remove(proc->handle);
+        shared_ptr<Process> owned;   // outlives the lock, so any free happens outside it
+        NameShard& shard = shardFor(proc->name);
+        lock_guard<shared_mutex> lock(shard.lock);
+        auto it = shard.byName.find(proc->name);
+        if (it == shard.byName.end()) return;
+        owned = move(it->second);
+        shard.byName.erase(it);
+        shard.retiredIds.emplace(owned->name, owned->id);
+    }
+
+    void listProcesses() {
+        cout << "-----------------------------\n";
+
+        // --- CPU Utilization Stats ---
+        int coresAvailable = GLOBAL_CONFIG.numCPU;
+        int coresUsed = processStats.busyCores();
+        double utilization = coresAvailable > 0
+            ? (static_cast<double>(coresUsed) / coresAvailable) * 100.0
+            : 0.0;
+        coresAvailable -= coresUsed;
+
+        cout << fixed << setprecision(2)
+            << "CPU Utilization: " << utilization << "%\n"
+            << "Cores Used:      " << coresUsed << "\n"
+            << "Cores Available: " << coresAvailable << "\n";
+        printSchedulerQueues(cout);
+        cout << "-----------------------------\n";
+
+        // --- Running Processes ---
+        cout << "Running processes:\n";
+        processStats.forEachRunning([](const Process& proc) {
+            cout << proc.name
+                << "\033[33m  (" << proc.timestamp << ") \033[0m"
+                << "Core: " << proc.coreAssigned
+                << " \033[33m" << proc.currentLine << " / " << proc.totalLine << "\033[0m"
+                << endl;
+        });
+
+        // --- Finished Processes ---
+        cout << "\nFinished processes:\n";
+        for (const ProcessSummary& proc : processStats.list(ProcessStats::List::FINISHED)) {
+            cout << proc.name
+                << " (" << proc.finishedTime << ") Finished "
+                << proc.totalLine << " / " << proc.totalLine
+                << endl;
+        }
+
+        // --- Shutdown Processes ---
+        cout << "\nShutdown processes:\n";
+        for (const ProcessSummary& proc : processStats.list(ProcessStats::List::SHUTDOWN)) {
+            cout << proc.name
+                << " (" << proc.shutdownTime << ") "
+                << proc.shutdownReason
+                << endl;
+        }
+
+        cout << "-----------------------------\n";
+    }
+
+
+    void logProcesses(const string& filename) {
+        ofstream logFile(filename);
+        if (!logFile.is_open()) {
+            cerr << "Failed to create log file: " << filename << endl;
+            return;
+        }
+
+        logFile << "-----------------------------\n";
+
+        int coresAvailable = GLOBAL_CONFIG.numCPU;
+        int coresUsed = processStats.busyCores();
+        double utilization = (coresAvailable > 0) ? (static_cast<double>(coresUsed) / coresAvailable) * 100.0 : 0.0;
+        coresAvailable = coresAvailable - coresUsed;
+
+        logFile << fixed << setprecision(2);
+        logFile << "CPU Utilization: " << utilization << "%\n";
+        logFile << "Cores Used:      " << coresUsed << "\n";
+        logFile << "Cores Available: " << coresAvailable << "\n";
+        printSchedulerQueues(logFile);
+        logFile << "-----------------------------\n";
 
-            // --- bounds check ---
-            if (address < 64 || address >= proc->memorySize) {
-                proc->isShutdown = true;
-                proc->shutdownReason = "Memory access violation at " + addrHex;
-                proc->shutdownTime = generateTimestamp();
-                instructions[currentLine]
-                    = prefix + "\"" + proc->shutdownReason + "\"";
-                return;
-            }
+        logFile << "Running processes:\n";
+        processStats.forEachRunning([&logFile](const Process& proc) {
+            logFile << proc.name << " (" << proc.timestamp << ") "
+                << "Core: " << proc.coreAssigned << " "
+                << proc.currentLine << " / " << proc.totalLine << endl;
+        });
 
-            size_t pageNum = min<uint64_t>(
-                address / GLOBAL_CONFIG.memPerFrame,
-                proc->pageTable.size() - 1
-            );
-            bool loaded = loadPageIfNotInMemory(proc, pageNum);
-            uint16_t val = memory.count(addrHex) ? memory[addrHex] : 0;
-            memory[var] = val;
-            log << "READ " << var << " = " << val
-                << " from " << addrHex
-                << (loaded ? " (loaded)" : " (not loaded)");
+        // Shut-down processes are reported as finished here, as before
+        logFile << "\nFinished processes:\n";
+        for (auto which : { ProcessStats::List::FINISHED, ProcessStats::List::SHUTDOWN }) {
+            for (const ProcessSummary& proc : processStats.list(which)) {
+                logFile << proc.name << " (" << proc.finishedTime << ") Finished "
+                    << proc.totalLine << " / " << proc.totalLine << endl;
+            }
         }
 
-        // --- PRINT("Result: " + var) ---
-        else if (regex_match(instr, m, regex(R"(PRINT\(\s*"Result: "\s*\+\s*([A-Za-z_]\w*)\s*\))"))) {
-            string var = m[1];
-            log << "PRINT(\"Result: \" + " << var << ") = " << memory[var];
-        }
+        logFile << "-----------------------------\n";
+        printCoreUtilization(logFile, GLOBAL_CONFIG.utilHistory);
+        logFile << "-----------------------------\n";
+        latencyStats.print(logFile);
+        logFile << "-----------------------------\n";
+        logFile.close();
+        cout << "Report saved to csopesy-log.txt\n";
+    }
 
-        // should never hit this if validation was correct
-        else {
-            log << "UNKNOWN_INSTR";
-        }
+};
 
-        // commit log and return
-        instructions[currentLine] = prefix + "\"" + log.str() + "\"";
-        return;
+ProcessManager processManager;
+
+// Parking for idle cores. An idle core parks on its own condition variable
+// and is only woken when work is queued somewhere it can take it, so an idle
+// emulator does not spin.
+struct alignas(64) CorePark {
+    mutex parkMutex;
+    condition_variable parkCv;
+    bool parked = false;
+    bool signaled = false;      // sticky wake-up, consumed by the next park
+    atomic<int64_t> parkedSinceNs = 0;  // steady_clock time parked, 0 if running
+};
+
+vector<unique_ptr<CorePark>> coreParks;       // index = coreId - 1
+atomic<size_t> readyProcesses = 0;            // total queued in the scheduler
+atomic<int> parkedCores = 0;
+atomic<bool> stopScheduler = false;
+
+// What each core is running between scheduling steps, and its counters.
+// One cache line per core, written only by that core (or the single
+// --virtual-time loop); process-smi, report-util and the sampler read the
+// counters from other threads.
+struct alignas(64) CoreState {
+    Process* current = nullptr;
+    uint64_t sliceUsed = 0;     // instructions run in the current quantum
+    atomic<uint64_t> busyNs = 0;        // time spent running instructions
+    atomic<uint64_t> idleNs = 0;        // time spent parked, charged on wake
+    atomic<uint64_t> contextSwitches = 0;   // processes dispatched
+    atomic<uint64_t> retired = 0;       // instructions executed
+    atomic<uint64_t> migrationsIn = 0;  // dispatches of a process last run on another core
+};
+
+vector<CoreState> coreStates;   // index = coreId - 1
+
+// Counter update with a single writer: a plain load and store, no locked
+// read-modify-write
+void bumpCounter(atomic<uint64_t>& counter, uint64_t by = 1) {
+    counter.store(counter.load(memory_order_relaxed) + by, memory_order_relaxed);
+}
+
+// CPU ticks are steps of delay-per-exec (at least 1 ms)
+chrono::nanoseconds idleTickPeriod() {
+    return chrono::milliseconds(max<uint64_t>(GLOBAL_CONFIG.delayPerExec, 1));
+}
+
+// Time base for park accounting: steady clock, or the simulated cycle clock
+int64_t steadyNowNs() {
+    return clockService.monotonicNs() + 1;   // never 0, which means "not parked"
+}
+
+void markParked(int coreId) {
+    CorePark& rq = *coreParks[coreId - 1];
+    rq.parkedSinceNs = steadyNowNs();
+    rq.parked = true;
+    parkedCores++;
+}
+
+// Clears the park and charges the time it lasted to the core's idle time
+void markUnparked(int coreId) {
+    CorePark& rq = *coreParks[coreId - 1];
+    uint64_t idle = static_cast<uint64_t>(steadyNowNs() - rq.parkedSinceNs.load());
+    rq.parked = false;
+    parkedCores--;
+    rq.signaled = false;
+    rq.parkedSinceNs = 0;
+    bumpCounter(coreStates[coreId - 1].idleNs, idle);
+}
+
+// Wakes `coreId`; returns whether it was actually parked
+bool wakeCore(int coreId) {
+    CorePark& rq = *coreParks[coreId - 1];
+    if (virtualTimeMode) {
+        // Single-threaded: resume the core with a step event right now
+        if (!rq.parked) return false;
+        markUnparked(coreId);
+        simulator.post(simulator.now(), EventSimulator::Kind::CoreStep, coreId);
+        return true;
+    }
+    lock_guard<mutex> lock(rq.parkMutex);
+    rq.signaled = true;
+    if (!rq.parked) return false;
+    rq.parkCv.notify_one();
+    return true;
+}
+
+void wakeAllCores() {
+    for (size_t i = 0; i < coreParks.size(); ++i) {
+        wakeCore(static_cast<int>(i) + 1);
     }
+}
 
-    // Random instruction generation
-    static thread_local mt19937 gen(random_device{}());
-    uniform_int_distribution<> cmdDistrib(0, 6);
-    uniform_int_distribution<> valDistrib(1, 100);
+// Wakes up to `count` parked cores, trying `firstCore` and then its
+// neighbours in order, never `skipCore`. With nothing parked this is a
+// single load.
+void wakeParkedCores(int firstCore, size_t count, int skipCore = 0) {
+    size_t n = coreParks.size();
+    for (size_t k = 0; k < n && count > 0 && parkedCores > 0; ++k) {
+        int coreId = static_cast<int>((firstCore - 1 + k) % n) + 1;
+        if (coreId != skipCore && wakeCore(coreId)) --count;
+    }
+}
 
-    stringstream ss;
-    stringstream log;
-    int cmd = cmdDistrib(gen);
+// Scheduling policy. The core loop (cpuWorker, or the --virtual-time event
+// loop) takes work with dequeue(), asks sliceExpired() after every
+// instruction and hands back an unfinished process with requeue(). The
+// instance is chosen once, at initialize. Implementations keep
+// readyProcesses equal to what they hold and wake parked cores for new work.
+class Scheduler {
+public:
+    virtual ~Scheduler() = default;
 
-    // Track declared vars
-    static thread_local vector<string> varNames;
+    // A new process is ready
+    virtual void enqueue(Process* proc) = 0;
 
-    // inside instructions_manager, replace the DECLARE case with:
-    static constexpr size_t MAX_DECLARED_VARS = 32;
+    // Several new processes at once; implementations may lock less often
+    virtual void enqueueBatch(const vector<Process*>& procs) {
+        for (Process* proc : procs) enqueue(proc);
+    }
 
+    // `proc` used up its slice on `coreId` and goes back in line
+    virtual void requeue(Process* proc, int coreId) = 0;
 
-    if (cmd == 1 || varNames.empty()) {
-        // DECLARE
-        string var = "v" + to_string(varNames.size());
-        uint16_t val = valDistrib(gen);
-
-        if (varNames.size() < MAX_DECLARED_VARS) {
-            // — original behavior —
-            /*if (loadPageIfNotInMemory(proc, 0)) {
-                int frameIdx = proc->pageTable[0].frameIndex;
-                std::lock_guard<std::mutex> lock(memMutex);
-                physicalMemory[frameIdx].data += "(" + var + " " + to_string(val) + ")";
-            }*/
-            if (loadPageIfNotInMemory(proc, 0)) {
-                int frameIdx = proc->pageTable[0].frameIndex;
-                if (frameIdx >= 0 && frameIdx < (int)physicalMemory.size()) {
-                    std::lock_guard<std::mutex> lock(memMutex);
-                    physicalMemory[frameIdx].data += "(" + var + " " + to_string(val) + ")";
-                }
-            }
-            else {
-                log << "WARNING: Page 0 not loaded; DECLARE attempted without memory.";
-            }
+    // Next process for `coreId`, or nullptr if there is nothing to run
+    virtual Process* dequeue(int coreId) = 0;
 
-            memory[var] = val;
-            varNames.push_back(var);
-            log << "DECLARE " << var << " = " << val;
+    // Whether dequeue(coreId) could find something; checked before parking
+    virtual bool hasWorkFor(int /*coreId*/) const { return readyProcesses > 0; }
+
+    // Whether the process on a core must give it up after `sliceUsed`
+    // instructions: its quantum is spent or a better job is waiting. Only
+    // called by the core running `proc`.
+    virtual bool sliceExpired(const Process* proc, uint64_t sliceUsed) const = 0;
+
+    // Empties the queues, returning what was in them. Only call while no
+    // core is running.
+    virtual vector<Process*> drain() = 0;
+
+    // Queue depths for screen -ls and report-util; nothing by default
+    virtual void printQueues(ostream& /*out*/) const {}
+};
+
+// fcfs and rr: per-core ready deques. New processes are spread across the
+// cores; a core pops from the front of its own deque and, when that is empty,
+// steals from the back of another core's. Dispatch and rr requeues therefore
+// only take one core's lock instead of a global queue lock. A quantum of 0
+// means run to completion (fcfs).
+//
+// A preempted process goes back on the core it ran on. A process that has
+// run before is only stolen when the victim deque holds more than
+// migration-threshold processes, that is, when at least that many are
+// waiting behind the one its owner dispatches next. Warm processes therefore
+// stay put unless the imbalance is worth a migration; never-run processes
+// are stolen freely.
+class DequeScheduler : public Scheduler {
+public:
+    DequeScheduler(int numCores, uint64_t quantum, uint64_t migrationThreshold)
+        : quantum(quantum), migrationThreshold(migrationThreshold) {
+        for (int i = 0; i < numCores; ++i) {
+            deques.push_back(make_unique<CoreDeque>());
         }
-        else {
-            // — we've hit the 32‐var limit: ignore further DECLAREs —
-            log << "DECLARE ignored";
-            // (do *not* touch proc->pageTable[0].data, memory or varNames)
+    }
+
+    // Places a process on the next core in round-robin order and wakes that
+    // core, or a parked neighbour that can steal it
+    void enqueue(Process* proc) override {
+        int coreId = static_cast<int>(nextEnqueueCore++ % deques.size()) + 1;
+        push(proc, coreId);
+        wakeParkedCores(coreId, 1);
+    }
+
+    // Deals the batch round-robin over the cores, locking each deque once,
+    // and wakes one parked core per process
+    void enqueueBatch(const vector<Process*>& procs) override {
+        if (procs.empty()) return;
+        size_t n = deques.size();
+        size_t first = nextEnqueueCore.fetch_add(procs.size());
+        for (size_t k = 0; k < min(n, procs.size()); ++k) {
+            CoreDeque& dq = *deques[(first + k) % n];
+            lock_guard<mutex> lock(dq.lock);
+            for (size_t i = k; i < procs.size(); i += n) {
+                dq.ready.push_back(procs[i]->handle);
+            }
         }
+        readyProcesses += procs.size();
+        wakeParkedCores(static_cast<int>(first % n) + 1, procs.size());
     }
-    else if (cmd == 0 && !varNames.empty()) {
-        // PRINT
-        if (!loadPageIfNotInMemory(proc, 0)) {
-            log << "WARNING: Page 0 not loaded; DECLARE attempted without memory.";
+
+    // Back onto the core's own deque. The calling core dispatches from it
+    // next, so another core is only woken when the deque is deep enough for
+    // this warm process to be stolen.
+    void requeue(Process* proc, int coreId) override {
+        if (push(proc, coreId) > migrationThreshold) {
+            wakeParkedCores(coreId % static_cast<int>(deques.size()) + 1, 1, coreId);
         }
+    }
 
-        string var = varNames[gen() % varNames.size()];
-        uint16_t val = memory.count(var) ? memory[var] : 0;
-        log << "PRINT " << var << " = " << val;
+    // Own deque first, then a steal from the back of the other cores'
+    // deques, nearest neighbour first
+    Process* dequeue(int coreId) override {
+        if (readyProcesses == 0) return nullptr;
+        size_t n = deques.size();
+        size_t self = static_cast<size_t>(coreId - 1);
+        for (size_t k = 0; k < n; ++k) {
+            CoreDeque& dq = *deques[(self + k) % n];
+            lock_guard<mutex> lock(dq.lock);
+            while (!dq.ready.empty()) {
+                ProcessHandle handle = k == 0 ? dq.ready.front() : dq.ready.back();
+                Process* proc = processTable.get(handle);
+                if (proc && k != 0 && proc->coreAssigned != -1
+                    && dq.ready.size() <= migrationThreshold) {
+                    break;  // warm elsewhere and not enough imbalance to move it
+                }
+                if (k == 0) dq.ready.pop_front();
+                else dq.ready.pop_back();
+                readyProcesses--;
+
+                // Skip entries whose process was removed while queued
+                if (proc) return proc;
+            }
+        }
+        return nullptr;
     }
-    else if (cmd == 2 && varNames.size() >= 2) {
-        // ADD
-        if (!loadPageIfNotInMemory(proc, 0)) {
-            log << "WARNING: Page 0 not loaded; DECLARE attempted without memory.";
+
+    // Own deque non-empty, or another deque with a process this core may steal
+    bool hasWorkFor(int coreId) const override {
+        if (readyProcesses == 0) return false;
+        size_t n = deques.size();
+        size_t self = static_cast<size_t>(coreId - 1);
+        for (size_t k = 0; k < n; ++k) {
+            const CoreDeque& dq = *deques[(self + k) % n];
+            lock_guard<mutex> lock(dq.lock);
+            if (dq.ready.empty()) continue;
+            if (k == 0 || dq.ready.size() > migrationThreshold) return true;
+            Process* proc = processTable.get(dq.ready.back());
+            if (!proc || proc->coreAssigned == -1) return true;
         }
+        return false;
+    }
 
-        string a = varNames[gen() % varNames.size()];
-        string b = varNames[gen() % varNames.size()];
-        uint16_t valA = memory.count(a) ? memory[a] : 0;
-        uint16_t valB = memory.count(b) ? memory[b] : 0;
-        uint16_t result = clampUint16(valA + valB);
-        string resultVar = "res" + to_string(currentLine);
-        memory[resultVar] = result;
-        log << "ADD " << a << "(" << valA << ") + " << b << "(" << valB << ") = " << result;
+    bool sliceExpired(const Process* /*proc*/, uint64_t sliceUsed) const override {
+        return quantum != 0 && sliceUsed >= quantum;
     }
-    else if (cmd == 3 && varNames.size() >= 2) {
-        // SUBTRACT
-        if (!loadPageIfNotInMemory(proc, 0)) {
-            log << "WARNING: Page 0 not loaded; DECLARE attempted without memory.";
+
+    vector<Process*> drain() override {
+        vector<Process*> procs;
+        for (auto& dq : deques) {
+            for (ProcessHandle handle : dq->ready) {
+                if (Process* proc = processTable.get(handle)) procs.push_back(proc);
+            }
+            dq->ready.clear();
         }
+        readyProcesses = 0;
+        return procs;
+    }
+
+private:
+    struct alignas(64) CoreDeque {
+        mutable mutex lock;
+        deque<ProcessHandle> ready;
+    };
 
-        string a = varNames[gen() % varNames.size()];
-        string b = varNames[gen() % varNames.size()];
-        uint16_t valA = memory.count(a) ? memory[a] : 0;
-        uint16_t valB = memory.count(b) ? memory[b] : 0;
-        uint16_t result = clampUint16(valA - valB);
-        string resultVar = "res" + to_string(currentLine);
-        memory[resultVar] = result;
-        log << "SUBTRACT " << a << "(" << valA << ") - " << b << "(" << valB << ") = " << result;
+    // Appends to `coreId`'s deque; returns its new depth
+    size_t push(Process* proc, int coreId) {
+        CoreDeque& dq = *deques[coreId - 1];
+        size_t depth;
+        {
+            lock_guard<mutex> lock(dq.lock);
+            dq.ready.push_back(proc->handle);
+            depth = dq.ready.size();
+        }
+        readyProcesses++;
+        return depth;
     }
-    else if (cmd == 4) {
-        // SLEEP
-        int ms = 100;
-        this_thread::sleep_for(chrono::milliseconds(ms));
-        log << "SLEPT for " << ms << "ms";
+
+    vector<unique_ptr<CoreDeque>> deques;   // index = coreId - 1
+    atomic<size_t> nextEnqueueCore = 0;     // round-robin placement cursor
+    uint64_t quantum;
+    uint64_t migrationThreshold;
+};
+
+// Multi-level feedback queue. New processes enter level 0; a process that
+// uses up its quantum drops one level, and level L allows quantum-cycles x 2^L
+// instructions. Every mlfq-boost-ms (cycles under --virtual-time) everything
+// is moved back to level 0 so long jobs are not starved. Short interactive
+// programs finish at the top levels ahead of long batch processes.
+class MlfqScheduler : public Scheduler {
+public:
+    MlfqScheduler(int levels, uint64_t quantum, uint64_t boostMs)
+        : levels(levels), baseQuantum(max<uint64_t>(quantum, 1)),
+        boostNs(static_cast<int64_t>(boostMs) * 1000000),
+        nextBoostNs(clockService.monotonicNs() + boostNs),
+        queues(levels) {
     }
-    else if (cmd == 5) {
-        // READ
-        if (!varNames.empty()) {
-            // 1) Pick a target variable
-            string var = varNames[gen() % varNames.size()];
 
-            // 2) Pick a random address (same as before)
-            uint64_t minAddr = GLOBAL_CONFIG.memPerFrame;  // skip page 0
-            uint64_t maxAddr = proc->memorySize - 1;
-            if (maxAddr < minAddr) maxAddr = minAddr;
-            /*
-            uint64_t address = generateRandomDataAddress(minAddr, maxAddr);
-            int pageNumber = static_cast<int>(address / GLOBAL_CONFIG.memPerFrame);*/
-            uint64_t address = generateRandomDataAddress(minAddr, maxAddr);
-            size_t   rawPage = address / GLOBAL_CONFIG.memPerFrame;
-            size_t   lastPage = proc->pageTable.size() - 1;
-            size_t   pageNumber = std::min(rawPage, lastPage);
+    void enqueue(Process* proc) override {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            push(proc, 0);
+        }
+        readyProcesses++;
+        wakeParkedCores(1, 1);
+    }
 
+    void enqueueBatch(const vector<Process*>& procs) override {
+        if (procs.empty()) return;
+        {
+            lock_guard<mutex> lock(queueMutex);
+            for (Process* proc : procs) push(proc, 0);
+        }
+        readyProcesses += procs.size();
+        wakeParkedCores(1, procs.size());
+    }
 
-            // 3) Ensure the page is loaded
-            bool pageLoaded = loadPageIfNotInMemory(proc, pageNumber);
+    // Demoted one level, unless a boost happened while it was running
+    void requeue(Process* proc, int coreId) override {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            maybeBoost();
+            int level = proc->schedEpoch == boostEpoch
+                ? min(proc->schedLevel + 1, levels - 1) : 0;
+            push(proc, level);
+        }
+        readyProcesses++;
+        wakeParkedCores(coreId, 1);
+    }
 
-            // 4) Build the hex‐string key
-            stringstream addrHex;
-            addrHex << "0x" << hex << address;
-            string addrKey = addrHex.str();
+    // Front of the highest non-empty level
+    Process* dequeue(int /*coreId*/) override {
+        if (readyProcesses == 0) return nullptr;
+        lock_guard<mutex> lock(queueMutex);
+        maybeBoost();
+        for (deque<ProcessHandle>& level : queues) {
+            while (!level.empty()) {
+                ProcessHandle handle = level.front();
+                level.pop_front();
+                readyProcesses--;
+                if (Process* proc = processTable.get(handle)) {
+                    proc->schedEpoch = boostEpoch;
+                    return proc;
+                }
+            }
+        }
+        return nullptr;
+    }
 
-            // 5) Look up the value (or default to 0) and store it in your map
-            uint16_t readValue = memory.count(addrKey) ? memory[addrKey] : 0;
-            memory[var] = readValue;
+    bool sliceExpired(const Process* proc, uint64_t sliceUsed) const override {
+        return sliceUsed >= (baseQuantum << proc->schedLevel);
+    }
 
-            // 6) Log with the loaded‐page info
-            if (pageLoaded) {
-                log << "READ " << var << " = " << readValue
-                    << " from " << addrKey
-                    << " (Page " << dec << pageNumber << " loaded)";
+    vector<Process*> drain() override {
+        lock_guard<mutex> lock(queueMutex);
+        vector<Process*> procs;
+        for (deque<ProcessHandle>& level : queues) {
+            for (ProcessHandle handle : level) {
+                if (Process* proc = processTable.get(handle)) procs.push_back(proc);
             }
-            else {
-                log << "READ " << var << " = " << readValue
-                    << " from " << addrKey
-                    << " (Page " << dec << pageNumber << " not loaded - memory full)";
+            level.clear();
+        }
+        readyProcesses = 0;
+        return procs;
+    }
+
+    void printQueues(ostream& out) const override {
+        lock_guard<mutex> lock(queueMutex);
+        out << "MLFQ ready queues:\n";
+        for (int level = 0; level < levels; ++level) {
+            out << "  Level " << level << " (quantum " << (baseQuantum << level) << "): "
+                << queues[level].size() << " ready\n";
+        }
+    }
+
+private:
+    // Caller holds queueMutex
+    void push(Process* proc, int level) {
+        proc->schedLevel = level;
+        queues[level].push_back(proc->handle);
+    }
+
+    // Moves every lower level back to level 0, oldest first. Processes on a
+    // core pick the boost up through boostEpoch when they are requeued.
+    // Caller holds queueMutex.
+    void maybeBoost() {
+        int64_t now = clockService.monotonicNs();
+        if (boostNs <= 0 || now < nextBoostNs) return;
+        nextBoostNs = now + boostNs;
+        ++boostEpoch;
+        for (int level = 1; level < levels; ++level) {
+            for (ProcessHandle handle : queues[level]) {
+                if (Process* proc = processTable.get(handle)) {
+                    proc->schedLevel = 0;
+                    queues[0].push_back(handle);
+                }
+                else {
+                    readyProcesses--;
+                }
             }
+            queues[level].clear();
         }
     }
 
-    else if (cmd == 6) {
-        // WRITE
-        uint64_t minAddr = GLOBAL_CONFIG.memPerFrame;         // skip page 0
-        uint64_t maxAddr = proc->memorySize - 1;
-        if (maxAddr < minAddr) maxAddr = minAddr;
-        /*
-        uint64_t address = generateRandomDataAddress(minAddr, maxAddr);
-        int      pageNumber = address / GLOBAL_CONFIG.memPerFrame;*/
-        uint64_t address = generateRandomDataAddress(minAddr, maxAddr);
-        size_t   rawPage = address / GLOBAL_CONFIG.memPerFrame;
-        size_t   lastPage = proc->pageTable.size() - 1;
-        size_t   pageNumber = std::min(rawPage, lastPage);
-        uint16_t value = valDistrib(gen);
+    int levels;
+    uint64_t baseQuantum;
+    int64_t boostNs;
+    int64_t nextBoostNs;
+    uint64_t boostEpoch = 0;
+    mutable mutex queueMutex;
+    vector<deque<ProcessHandle>> queues;    // index = level, 0 is highest
+};
 
-        // Load the page if needed
-        bool pageLoaded = loadPageIfNotInMemory(proc, pageNumber);
+// sjf and srtf: one binary heap keyed on remaining instructions, under a
+// mutex. With aging-ms = A the key is remaining x A ms + arrival time, so each
+// A ms a job has existed counts as one instruction less; keys never change
+// while queued and a job that keeps being passed over still rises to the top.
+// Under srtf each new job claims at most one core to preempt: an idle core
+// if there is one, otherwise the core running the largest key above its
+// own. That core yields after its next instruction if the smallest queued
+// key, published without the lock, is still smaller than its own.
+class ShortestJobScheduler : public Scheduler {
+public:
+    ShortestJobScheduler(int numCores, bool preemptive, uint64_t agingMs)
+        : preemptive(preemptive), agingNs(agingMs * 1000000) {
+        for (int i = 0; i < numCores; ++i) {
+            cores.push_back(make_unique<CoreSlot>());
+        }
+    }
 
-        stringstream addrHex;
-        addrHex << "0x" << hex << address;
+    void enqueue(Process* proc) override {
+        {
+            lock_guard<mutex> lock(heapMutex);
+            push(proc);
+            claimPreemptions({ keyOf(proc) });
+        }
+        readyProcesses++;
+        wakeParkedCores(1, 1);
+    }
 
-        if (pageLoaded) {
-            // **Store into your "variable" map**
-            memory[addrHex.str()] = value;
+    void enqueueBatch(const vector<Process*>& procs) override {
+        if (procs.empty()) return;
+        {
+            lock_guard<mutex> lock(heapMutex);
+            vector<uint64_t> keys;
+            keys.reserve(procs.size());
+            for (Process* proc : procs) {
+                push(proc);
+                keys.push_back(keyOf(proc));
+            }
+            claimPreemptions(move(keys));
+        }
+        readyProcesses += procs.size();
+        wakeParkedCores(1, procs.size());
+    }
 
+    void requeue(Process* proc, int coreId) override {
+        {
+            lock_guard<mutex> lock(heapMutex);
+            push(proc);
+        }
+        readyProcesses++;
+        wakeParkedCores(coreId, 1);
+    }
 
-            int frameIdx = proc->pageTable[pageNumber].frameIndex;
-            if (frameIdx >= 0 && frameIdx < (int)physicalMemory.size()) {
-                std::lock_guard<std::mutex> lock(memMutex);
-                physicalMemory[frameIdx].data += "(" + addrHex.str() + " " + to_string(value) + ")";
+    Process* dequeue(int coreId) override {
+        CoreSlot& core = *cores[coreId - 1];
+        core.preempt.store(false, memory_order_relaxed);
+        core.runningKey.store(IDLE, memory_order_relaxed);
+        if (readyProcesses == 0) return nullptr;
+        lock_guard<mutex> lock(heapMutex);
+        while (!heap.empty()) {
+            pop_heap(heap.begin(), heap.end(), greater<Entry>());
+            ProcessHandle handle = heap.back().handle;
+            heap.pop_back();
+            readyProcesses--;
+            publishMin();
+            if (Process* proc = processTable.get(handle)) {
+                core.runningKey.store(keyOf(proc), memory_order_relaxed);
+                return proc;
             }
+        }
+        return nullptr;
+    }
 
-            log << "WRITE " << addrHex.str() << " " << dec << value
-                << " (Page " << pageNumber << " loaded)";
+    // Only a core claimed by a new arrival yields, and only if a smaller job
+    // is still waiting
+    bool sliceExpired(const Process* proc, uint64_t /*sliceUsed*/) const override {
+        if (!preemptive) return false;
+        int coreId = proc->coreAssigned;
+        if (coreId < 1 || coreId > static_cast<int>(cores.size())) return false;
+        CoreSlot& core = *cores[coreId - 1];
+        uint64_t key = keyOf(proc);
+        core.runningKey.store(key, memory_order_relaxed);
+        if (!core.preempt.exchange(false, memory_order_relaxed)) return false;
+        return minKey.load(memory_order_relaxed) < key;
+    }
+
+    vector<Process*> drain() override {
+        lock_guard<mutex> lock(heapMutex);
+        vector<Process*> procs;
+        for (const Entry& entry : heap) {
+            if (Process* proc = processTable.get(entry.handle)) procs.push_back(proc);
         }
-        else {
-            log << "WRITE " << addrHex.str() << " " << dec << value
-                << " (Page " << pageNumber << " not loaded - memory full)";
+        heap.clear();
+        publishMin();
+        readyProcesses = 0;
+        return procs;
+    }
+
+    void printQueues(ostream& out) const override {
+        lock_guard<mutex> lock(heapMutex);
+        out << (preemptive ? "SRTF" : "SJF") << " ready heap: " << heap.size() << " ready";
+        if (!heap.empty()) out << ", next has " << heap.front().remaining << " instructions left";
+        out << "\n";
+    }
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint64_t seq;           // FIFO among equal keys
+        uint64_t remaining;
+        ProcessHandle handle;
+
+        bool operator>(const Entry& other) const {
+            return key != other.key ? key > other.key : seq > other.seq;
         }
+    };
+
+    uint64_t keyOf(const Process* proc) const {
+        uint64_t remaining = proc->totalLine - proc->currentLine;
+        return agingNs == 0 ? remaining : remaining * agingNs + static_cast<uint64_t>(proc->arrivalNs);
     }
 
-    else {
-        // FOR
-        if (varNames.empty()) {
-            string var = "v" + to_string(varNames.size());
-            uint16_t val = valDistrib(gen);
-            memory[var] = val;
-            varNames.push_back(var);
+    // Caller holds heapMutex
+    void push(Process* proc) {
+        heap.push_back({ keyOf(proc), nextSeq++, proc->totalLine - proc->currentLine, proc->handle });
+        push_heap(heap.begin(), heap.end(), greater<Entry>());
+        publishMin();
+    }
+
+    // Picks the cores that should make room for jobs with `keys`, just
+    // pushed. Each job takes an idle core if one is left, else flags the
+    // unclaimed core running the largest key above its own. Caller holds
+    // heapMutex.
+    void claimPreemptions(vector<uint64_t> keys) {
+        if (!preemptive) return;
+        size_t idle = 0;
+        for (const auto& core : cores) {
+            if (core->runningKey.load(memory_order_relaxed) == IDLE) ++idle;
+        }
+        sort(keys.begin(), keys.end());
+        for (uint64_t key : keys) {
+            if (idle > 0) {
+                --idle;
+                continue;
+            }
+            CoreSlot* victim = nullptr;
+            uint64_t victimKey = key;
+            for (const auto& core : cores) {
+                uint64_t running = core->runningKey.load(memory_order_relaxed);
+                if (running > victimKey && !core->preempt.load(memory_order_relaxed)) {
+                    victim = core.get();
+                    victimKey = running;
+                }
+            }
+            if (!victim) break;   // larger keys cannot find a victim either
+            victim->preempt.store(true, memory_order_relaxed);
         }
+    }
 
-        string var = varNames[gen() % varNames.size()];
-        int count = 3;
-        if (!memory.count(var)) memory[var] = 0;
+    // Caller holds heapMutex
+    void publishMin() {
+        minKey.store(heap.empty() ? numeric_limits<uint64_t>::max() : heap.front().key,
+            memory_order_relaxed);
+    }
+
+    // What a core is running, for srtf victim selection
+    struct alignas(64) CoreSlot {
+        atomic<uint64_t> runningKey = IDLE;
+        atomic<bool> preempt = false;   // claimed by a new arrival
+    };
+
+    static constexpr uint64_t IDLE = 0;   // no key is 0: a queued job has work left
+
+    bool preemptive;
+    uint64_t agingNs;
+    vector<unique_ptr<CoreSlot>> cores;   // index = coreId - 1
+    mutable mutex heapMutex;
+    vector<Entry> heap;                 // min-heap on (key, seq)
+    uint64_t nextSeq = 0;
+    atomic<uint64_t> minKey = numeric_limits<uint64_t>::max();
+};
+
+unique_ptr<Scheduler> scheduler;
 
-        log << "FOR loop on " << var << ": ";
-        for (int i = 0; i < count; ++i) {
-            memory[var]++;
-            log << "[" << i + 1 << "]=" << memory[var] << " ";
+void printSchedulerQueues(ostream& out) {
+    if (scheduler) scheduler->printQueues(out);
+}
+
+// The policy named by the `scheduler` config key
+unique_ptr<Scheduler> makeScheduler(int numCores) {
+    if (GLOBAL_CONFIG.scheduler == "mlfq") {
+        return make_unique<MlfqScheduler>(static_cast<int>(GLOBAL_CONFIG.mlfqLevels),
+            GLOBAL_CONFIG.quantumCycles, GLOBAL_CONFIG.mlfqBoostMs);
+    }
+    if (GLOBAL_CONFIG.scheduler == "sjf" || GLOBAL_CONFIG.scheduler == "srtf") {
+        return make_unique<ShortestJobScheduler>(numCores, GLOBAL_CONFIG.scheduler == "srtf",
+            GLOBAL_CONFIG.agingMs);
+    }
+    uint64_t quantum = GLOBAL_CONFIG.scheduler == "rr" ? max<uint64_t>(GLOBAL_CONFIG.quantumCycles, 1) : 0;
+    return make_unique<DequeScheduler>(numCores, quantum, GLOBAL_CONFIG.migrationThreshold);
+}
+
+// Builds the configured scheduler and one park slot per core, carrying over
+// anything still ready or still on a core. Only call while no cpuWorker is
+// running.
+void resetScheduler(int numCores) {
+    vector<Process*> carried;
+    for (CoreState& core : coreStates) {
+        if (core.current) {
+            core.current->readyNs = clockService.monotonicNs();
+            carried.push_back(core.current);
         }
     }
+    coreStates = vector<CoreState>(numCores);
+    if (scheduler) {
+        vector<Process*> queued = scheduler->drain();
+        carried.insert(carried.end(), queued.begin(), queued.end());
+    }
+    coreParks.clear();
+    for (int i = 0; i < numCores; ++i) {
+        coreParks.push_back(make_unique<CorePark>());
+    }
+    readyProcesses = 0;
+    parkedCores = 0;
+    processStats.resetCores();
+    scheduler = makeScheduler(numCores);
+    scheduler->enqueueBatch(carried);
+}
 
-    // Save result in instruction log
-    instructions[currentLine] = prefix + "\"" + log.str() + "\"";
+// Idle time accrued by a core that is still parked and not yet charged
+uint64_t pendingIdleNs(int coreId) {
+    int64_t since = coreParks[coreId - 1]->parkedSinceNs.load();
+    return since != 0 ? static_cast<uint64_t>(steadyNowNs() - since) : 0;
 }
 
-void printProcessDetails(const Process& proc) {
-    // If the process was shutdown, show the violation message and return
-    if (proc.isShutdown) {
-        cout << "Process " << proc.name
-            << " shutdown due to memory access violation error that occurred at "
-            << proc.shutdownTime << ". "
-            << proc.shutdownReason << " invalid."
-            << endl;
+// Parks `coreId` until work is enqueued or the scheduler stops; idle time
+// is charged from elapsed time when it is woken rather than per wakeup.
+// Under --virtual-time this only records the park and returns.
+void parkCore(int coreId) {
+    CorePark& rq = *coreParks[coreId - 1];
+    if (virtualTimeMode) {
+        if (!rq.parked && !scheduler->hasWorkFor(coreId)) markParked(coreId);
         return;
     }
 
-    // Otherwise, show the normal details
-    cout << "Process: " << proc.name << endl;
-    cout << "ID: " << proc.id << endl;
-    cout << "Memory Size: " << proc.memorySize << " bytes" << endl;
-    cout << "Instruction: " << proc.currentLine << " of " << proc.totalLine << endl;
-    cout << "Created: " << proc.timestamp << endl;
+    unique_lock<mutex> lock(rq.parkMutex);
+    if (rq.signaled || stopScheduler) {
+        rq.signaled = false;
+        return;
+    }
+    // Counted as parked before the last look at the queues, so an enqueue
+    // this look misses sees the park and wakes the core
+    markParked(coreId);
+    if (!scheduler->hasWorkFor(coreId)) {
+        rq.parkCv.wait(lock, [&rq] { return rq.signaled || stopScheduler; });
+    }
+    markUnparked(coreId);
+}
 
-    cout << "Page Table (" << proc.pageTable.size() << " pages):\n";
-    for (size_t i = 0; i < proc.pageTable.size(); ++i) {
-        cout << "  Page " << i
-            << ": inMemory=" << boolalpha << proc.pageTable[i].inMemory
-            << ", frameIndex=" << proc.pageTable[i].frameIndex
-            << endl;
+// Frees everything a finished or shut-down process no longer needs. Its
+// frames go straight back to the allocator. Its backing-store slots and
+// queued write-backs are dropped. Its log, page table, program and symbol
+// table are released. processStats keeps a summary for screen -ls and
+// report-util, and the Process itself is freed with its pid slot.
+void retireProcess(Process* proc) {
+    {
+        std::lock_guard<std::mutex> lock(proc->ptMutex);
+        releaseProcessFrames(proc);
+        vector<PageTableEntry>().swap(proc->pageTable);
+    }
+    writeback.discardProcess(proc->id);
+    backingStore.discardProcess(proc->id);
+
+    proc->instructions.release();
+    vector<Instruction>().swap(proc->program);
+    {
+        lock_guard<mutex> lock(proc->varsMutex);
+        proc->vars = SymbolTable();
     }
 
-    cout << "\033[33m";
-    cout << "Type 'exit' to quit, 'clear' to clear the screen" << endl;
-    cout << "\033[0m";
+    processStats.retired(proc);
+    processManager.release(proc);
 }
 
-
-void displayProcess(const Process& proc) {
-    printProcessDetails(proc);
-    string subCommand;
-    while (true) {
-        cout << "Enter a command: ";
-        getline(cin, subCommand);
-        if (subCommand == "exit") break;
-        else if (subCommand == "clear") {
-            clearScreen();
-            printProcessDetails(proc);
+// Runs one instruction on `coreId`, dispatching a process first if the core
+// has none. Returns false if there was nothing to run or steal. Shared by the
+// real-time worker threads and the --virtual-time event loop.
+bool coreStep(int coreId) {
+    CoreState& core = coreStates[coreId - 1];
+    if (!core.current) {
+        core.current = scheduler->dequeue(coreId);
+        if (!core.current) return false;
+
+        processStats.coreTaken();
+        bumpCounter(core.contextSwitches);
+        int64_t now = clockService.monotonicNs();
+        core.current->waitNs += now - core.current->readyNs;
+        int lastCore = core.current->coreAssigned.exchange(coreId);
+        if (lastCore == -1) {
+            latencyStats.response.record(static_cast<uint64_t>(now - core.current->arrivalNs));
+            processStats.started(core.current);
         }
-        else if (subCommand == "process-smi") {
-            cout << "\nprocess_name: " << proc.name << endl;
-            cout << "ID: " << proc.id << endl;
-            cout << "Logs:\n(" << proc.timestamp << ") Core: " << proc.coreAssigned << endl;
-            cout << "\nCurrent instruction line " << proc.currentLine << endl;
-            cout << "Lines of code: " << proc.totalLine << endl;
-            // Print only finished instructions
-            if (!proc.isFinished) {
-                for (uint64_t i = 0; i < proc.currentLine && i < proc.instructions.size(); ++i) {
-                    cout << "  - " << proc.instructions[i] << endl;
-                }
-            }
-            else {
-                cout << "\nStatus: finished\n";
-            }
-            cout << endl;
+        else if (lastCore != coreId) {
+            // Cold cache on the new core
+            core.current->migrations++;
+            bumpCounter(core.migrationsIn);
+            simSleep(GLOBAL_CONFIG.migrationPenalty);
+        }
+        core.sliceUsed = 0;
+    }
+
+    Process* proc = core.current;
+    if (proc->currentLine < proc->totalLine) {
+        instructions_manager(proc->currentLine, proc->instructions, proc->vars, proc->name, coreId, proc);
+        proc->currentLine++;
+        core.sliceUsed++;
+        bumpCounter(core.retired);
+    }
+
+    if (proc->currentLine >= proc->totalLine || proc->isShutdown) {
+        // A shut-down process stops here rather than idling to its last line
+        proc->finishedTime = generateTimestamp();
+        proc->finishNs = clockService.monotonicNs();
+        latencyStats.wait.record(static_cast<uint64_t>(proc->waitNs));
+        latencyStats.turnaround.record(static_cast<uint64_t>(proc->finishNs - proc->arrivalNs));
+        proc->isFinished = true;
+        retireProcess(proc);
+        processStats.coreReleased();
+        core.current = nullptr;
+    }
+    else if (scheduler->sliceExpired(proc, core.sliceUsed)) {
+        // Preempted: back to the scheduler
+        processStats.coreReleased();
+        proc->readyNs = clockService.monotonicNs();
+        core.current = nullptr;
+        scheduler->requeue(proc, coreId);
+    }
+    return true;
+}
+
+void cpuWorker(int coreId) {
+    CoreState& core = coreStates[coreId - 1];
+    while (!stopScheduler) {
+        int64_t stepStart = steadyNowNs();
+        if (coreStep(coreId)) {
+            this_thread::sleep_for(chrono::milliseconds(GLOBAL_CONFIG.delayPerExec));
+            bumpCounter(core.busyNs, static_cast<uint64_t>(steadyNowNs() - stepStart));
         }
         else {
-            cout << "Unknown command inside process view." << endl;
+            // Nothing to run or steal: sleep until woken
+            parkCore(coreId);
         }
     }
 }
 
-class ProcessManager {
-private:
-    unordered_map<string, unique_ptr<Process>> processes;
-    int nextProcessID = 1;
-public:
-    /// Expose all processes so stats can iterate them
-    const unordered_map<string, unique_ptr<Process>>& getProcesses() const {
-        return processes;
-    }
+// Rolling per-core utilization. Every util-sample-ms (cycles under
+// --virtual-time) each core's busy and idle time since the previous sample
+// becomes one percentage in a ring of util-history samples. A thread drives
+// it in real time; the --virtual-time loop calls catchUp as the clock moves.
+class UtilizationSampler {
 public:
-    void createProcess(string name) {
-        if (processes.find(name) != processes.end()) {
-            cout << "Process " << name << " already exists." << endl;
-            return;
-        }
-        uint64_t cpuBurst = cpuBurstGenerator();
-        vector<string> instructions;
-        uint64_t memSize = generateRandomMemSize();
-        uint64_t pageCount = memSize / GLOBAL_CONFIG.memPerFrame;
-        vector<PageTableEntry> table(pageCount);
-        processes[name] = make_unique<Process>(Process{
-            nextProcessID++,
-            name,
-            0,
-            cpuBurst,
-            generateTimestamp(),
-            -1,
-            false,
-            "",
-            instructions,
-            {},
-            memSize,
-            table
-            });
-        processLookup[processes[name]->id] = processes[name].get();
-    }
-
-    Process* retrieveProcess(const string& name) {
-        auto it = processes.find(name);
-        return it != processes.end() ? it->second.get() : nullptr;
+    // Only call while no core is running and the sampler is stopped
+    void reset(int numCores) {
+        lock_guard<mutex> lock(samplesMutex);
+        periodNs = static_cast<int64_t>(GLOBAL_CONFIG.utilSampleMs) * 1000000;
+        capacity = GLOBAL_CONFIG.utilHistory;
+        cores.assign(numCores, CoreHistory());
+        nextSampleNs = clockService.monotonicNs() + periodNs;
     }
 
-    void listProcesses() {
-        cout << "-----------------------------\n";
-
-        // --- CPU Utilization Stats ---
-        unordered_set<int> coresUsedSet;
-        for (auto& [name, proc] : processes) {
-            if (!proc->isFinished && !proc->isShutdown && proc->coreAssigned != -1) {
-                coresUsedSet.insert(proc->coreAssigned);
-            }
-        }
-        int coresAvailable = GLOBAL_CONFIG.numCPU;
-        int coresUsed = static_cast<int>(coresUsedSet.size());
-        double utilization = coresAvailable > 0
-            ? (static_cast<double>(coresUsed) / coresAvailable) * 100.0
-            : 0.0;
-        coresAvailable -= coresUsed;
-
-        cout << fixed << setprecision(2)
-            << "CPU Utilization: " << utilization << "%\n"
-            << "Cores Used:      " << coresUsed << "\n"
-            << "Cores Available: " << coresAvailable << "\n"
-            << "-----------------------------\n";
-
-        // --- Running Processes ---
-        cout << "Running processes:\n";
-        for (auto& [name, proc] : processes) {
-            if (!proc->isFinished && !proc->isShutdown && proc->coreAssigned != -1) {
-                cout << name
-                    << "\033[33m  (" << proc->timestamp << ") \033[0m"
-                    << "Core: " << proc->coreAssigned
-                    << " \033[33m" << proc->currentLine << " / " << proc->totalLine << "\033[0m"
-                    << endl;
-            }
-        }
+    void start() {
+        lock_guard<mutex> lock(samplesMutex);
+        stopping = false;
+        sampler = thread(&UtilizationSampler::run, this);
+    }
 
-        // --- Finished Processes ---
-        cout << "\nFinished processes:\n";
-        for (auto& [name, proc] : processes) {
-            if (proc->isFinished && !proc->isShutdown) {
-                cout << name
-                    << " (" << proc->finishedTime << ") Finished "
-                    << proc->totalLine << " / " << proc->totalLine
-                    << endl;
-            }
+    void stop() {
+        {
+            lock_guard<mutex> lock(samplesMutex);
+            if (!sampler.joinable()) return;
+            stopping = true;
         }
+        stopCv.notify_all();
+        sampler.join();
+    }
 
-        // --- Shutdown Processes ---
-        cout << "\nShutdown processes:\n";
-        for (auto& [name, proc] : processes) {
-            if (proc->isShutdown) {
-                cout << name
-                    << " (" << proc->shutdownTime << ") "
-                    << proc->shutdownReason
-                    << endl;
-            }
+    // Takes every sample due at or before `nowNs`
+    void catchUp(int64_t nowNs) {
+        lock_guard<mutex> lock(samplesMutex);
+        while (nowNs >= nextSampleNs) {
+            takeSample(nextSampleNs);
+            nextSampleNs += periodNs;
         }
-
-        cout << "-----------------------------\n";
     }
 
-
-    void logProcesses(const string& filename) {
-        ofstream logFile(filename);
-        if (!logFile.is_open()) {
-            cerr << "Failed to create log file: " << filename << endl;
-            return;
+    // Up to `count` most recent samples of core `index`, oldest first
+    vector<uint8_t> history(size_t index, size_t count) const {
+        lock_guard<mutex> lock(samplesMutex);
+        const CoreHistory& core = cores[index];
+        size_t n = min(count, core.samples.size());
+        vector<uint8_t> out;
+        for (size_t i = core.samples.size() - n; i < core.samples.size(); ++i) {
+            out.push_back(core.samples[(core.head + i) % core.samples.size()]);
         }
+        return out;
+    }
 
-        logFile << "-----------------------------\n";
+private:
+    struct CoreHistory {
+        uint64_t lastBusyNs = 0;
+        uint64_t lastIdleNs = 0;
+        uint8_t lastPercent = 0;
+        vector<uint8_t> samples;    // ring once full; head is the oldest
+        size_t head = 0;
+    };
 
-        unordered_set<int> coresUsedSet;
-        for (const auto& [name, proc] : processes) {
-            if (!proc->isFinished && proc->coreAssigned != -1) {
-                coresUsedSet.insert(proc->coreAssigned);
+    void run() {
+        unique_lock<mutex> lock(samplesMutex);
+        while (!stopping) {
+            int64_t waitNs = nextSampleNs - clockService.monotonicNs();
+            if (waitNs > 0) {
+                stopCv.wait_for(lock, chrono::nanoseconds(waitNs));
+                continue;
             }
+            lock.unlock();
+            catchUp(clockService.monotonicNs());
+            lock.lock();
         }
+    }
 
-        int coresAvailable = GLOBAL_CONFIG.numCPU;
-        int coresUsed = static_cast<int>(coresUsedSet.size());
-        double utilization = (coresAvailable > 0) ? (static_cast<double>(coresUsed) / coresAvailable) * 100.0 : 0.0;
-        coresAvailable = coresAvailable - coresUsed;
-
-        logFile << fixed << setprecision(2);
-        logFile << "CPU Utilization: " << utilization << "%\n";
-        logFile << "Cores Used:      " << coresUsed << "\n";
-        logFile << "Cores Available: " << coresAvailable << "\n";
-        logFile << "-----------------------------\n";
-
-        logFile << "Running processes:\n";
-        for (const auto& [name, proc] : processes) {
-            if (!proc->isFinished && proc->coreAssigned != -1) {
-                logFile << name << " (" << proc->timestamp << ") "
-                    << "Core: " << proc->coreAssigned << " "
-                    << proc->currentLine << " / " << proc->totalLine << endl;
+    // Caller holds samplesMutex. Idle time of a still-parked core counts up
+    // to `atNs`, the sample boundary.
+    void takeSample(int64_t atNs) {
+        for (size_t i = 0; i < cores.size(); ++i) {
+            CoreHistory& core = cores[i];
+            uint64_t busy = coreStates[i].busyNs.load();
+            uint64_t idle = coreStates[i].idleNs.load();
+            int64_t since = coreParks[i]->parkedSinceNs.load();
+            if (since != 0 && since <= atNs + 1) idle += static_cast<uint64_t>(atNs + 1 - since);
+
+            uint64_t dBusy = busy - core.lastBusyNs;
+            uint64_t dIdle = idle > core.lastIdleNs ? idle - core.lastIdleNs : 0;
+            core.lastBusyNs = busy;
+            core.lastIdleNs = idle;
+            // Nothing charged yet means one long step is still running
+            if (dBusy + dIdle > 0) {
+                core.lastPercent = static_cast<uint8_t>(min<uint64_t>(100, dBusy * 100 / (dBusy + dIdle)));
             }
-        }
 
-        logFile << "\nFinished processes:\n";
-        for (const auto& [name, proc] : processes) {
-            if (proc->isFinished) {
-                logFile << name << " (" << proc->finishedTime << ") Finished "
-                    << proc->totalLine << " / " << proc->totalLine << endl;
+            if (core.samples.size() < capacity) {
+                core.samples.push_back(core.lastPercent);
+            }
+            else {
+                core.samples[core.head] = core.lastPercent;
+                core.head = (core.head + 1) % capacity;
             }
         }
-
-        logFile << "-----------------------------\n";
-        logFile.close();
-        cout << "Report saved to csopesy-log.txt\n";
     }
 
+    mutable mutex samplesMutex;
+    condition_variable stopCv;
+    thread sampler;
+    bool stopping = false;
+    int64_t periodNs = 1000000000;
+    int64_t nextSampleNs = 0;
+    size_t capacity = 60;
+    vector<CoreHistory> cores;  // index = coreId - 1
 };
 
-void displaySystemStats(const ProcessManager& manager) {
-    std::lock_guard<std::mutex> lock(memMutex);
+UtilizationSampler utilSampler;
+
+// Per-core counters (in CPU ticks) and the last `samples` utilization
+// samples, for process-smi and report-util
+void printCoreUtilization(ostream& out, size_t samples) {
+    uint64_t tickNs = static_cast<uint64_t>(idleTickPeriod().count());
+    out << "Per-core utilization (ticks of " << tickNs / 1000000 << " ms; history: last "
+        << samples << " samples of " << GLOBAL_CONFIG.utilSampleMs << " ms, oldest first):\n";
+    out << "Core  Busy        Idle        CtxSwitch  Retired     Migr-in  History %\n";
+    for (size_t i = 0; i < coreStates.size(); ++i) {
+        const CoreState& core = coreStates[i];
+        uint64_t idleNs = core.idleNs.load() + pendingIdleNs(static_cast<int>(i) + 1);
+        out << left << setw(6) << (i + 1)
+            << setw(12) << core.busyNs.load() / tickNs
+            << setw(12) << idleNs / tickNs
+            << setw(11) << core.contextSwitches.load()
+            << setw(12) << core.retired.load()
+            << setw(9) << core.migrationsIn.load() << right;
+        for (uint8_t percent : utilSampler.history(i, samples)) {
+            out << setw(4) << static_cast<int>(percent);
+        }
+        out << "\n";
+    }
+}
 
+void displaySystemStats() {
     // --- CPU Utilization ---
-    unordered_set<int> coresInUse;
-    for (auto& [name, procPtr] : manager.getProcesses()) {
-        if (!procPtr->isFinished && procPtr->coreAssigned != -1)
-            coresInUse.insert(procPtr->coreAssigned);
-    }
-    int usedCores = (int)coresInUse.size();
+    int usedCores = processStats.busyCores();
     int totalCores = GLOBAL_CONFIG.numCPU;
     double cpuUtil = totalCores ? (100.0 * usedCores / totalCores) : 0.0;
 
@@ -976,10 +3537,7 @@ void displaySystemStats(const ProcessManager& manager) {
         << usedCores << " / " << totalCores << " cores)\n";
 
     // --- Physical Memory Usage ---
-    size_t usedFrames = 0;
-    for (auto& frame : physicalMemory) {
-        if (frame.processId != -1) ++usedFrames;
-    }
+    size_t usedFrames = frameAllocator.used();
     uint64_t frameSize = GLOBAL_CONFIG.memPerFrame;
     uint64_t usedBytes = usedFrames * frameSize;
     uint64_t totalBytes = GLOBAL_CONFIG.maxOverallMem;
@@ -992,106 +3550,45 @@ void displaySystemStats(const ProcessManager& manager) {
 
     // --- Per‐Process Memory Usage ---
     cout << "Running Processes Memory Usage:\n";
-    for (auto& [name, procPtr] : manager.getProcesses()) {
-        if (procPtr->isFinished) continue;
-        size_t loadedPages = 0;
-        for (auto& e : procPtr->pageTable)
-            if (e.inMemory) ++loadedPages;
-        uint64_t procUsedBytes = loadedPages * frameSize;
-        cout << "  " << name << ": "
+    processStats.forEachRunning([frameSize](const Process& proc) {
+        uint64_t procUsedBytes = proc.residentPages.load() * frameSize;
+        cout << "  " << proc.name << ": "
             << procUsedBytes << " / "
-            << procPtr->memorySize << " bytes\n";
-    }
+            << proc.memorySize << " bytes\n";
+    });
+
+    cout << endl;
+    printCoreUtilization(cout, 10);
     cout << endl;
 }
 
-
-queue<Process*> fcfsQueue;
-queue<Process*> rrQueue;
-mutex queueMutex;
-condition_variable cv;
-bool stopScheduler = false;
-bool stopProcessCreation = false;
-
-void cpuWorker(int coreId) {
-    while (!stopScheduler) {
-        Process* proc = nullptr;
-        {
-            unique_lock<mutex> lock(queueMutex);
-            cv.wait_for(lock, chrono::milliseconds(1), [] {
-                return (!fcfsQueue.empty() || !rrQueue.empty()) || stopScheduler;
-                });
-
-            // Count total CPU tick regardless of whether a process is found
-            totalCpuTicks++;
-
-            if (GLOBAL_CONFIG.scheduler == "fcfs" && !fcfsQueue.empty()) {
-                proc = fcfsQueue.front();
-                fcfsQueue.pop();
-            }
-            else if (GLOBAL_CONFIG.scheduler == "rr" && !rrQueue.empty()) {
-                proc = rrQueue.front();
-                rrQueue.pop();
-            }
-        }
-
-        if (proc) {
-            // Core is working this cycle
-            activeCpuTicks++;
-
-            proc->coreAssigned = coreId;
-
-            if (GLOBAL_CONFIG.scheduler == "fcfs") {
-                while (proc->currentLine < proc->totalLine && !stopScheduler) {
-                    instructions_manager(proc->currentLine, proc->instructions, proc->memory, proc->name, coreId, proc);
-                    proc->currentLine++;
-                    this_thread::sleep_for(chrono::milliseconds(GLOBAL_CONFIG.delayPerExec));
-                }
-            }
-            else if (GLOBAL_CONFIG.scheduler == "rr") {
-                uint64_t executedInstructions = 0;
-                while (proc->currentLine < proc->totalLine &&
-                    executedInstructions < GLOBAL_CONFIG.quantumCycles &&
-                    !stopScheduler) {
-
-                    instructions_manager(proc->currentLine, proc->instructions, proc->memory, proc->name, coreId, proc);
-                    proc->currentLine++;
-                    executedInstructions++;
-                    this_thread::sleep_for(chrono::milliseconds(GLOBAL_CONFIG.delayPerExec));
-                }
-
-                if (proc->currentLine < proc->totalLine) {
-                    lock_guard<mutex> lock(queueMutex);
-                    rrQueue.push(proc);
-                    cv.notify_one();
-                    continue;
-                }
-            }
-
-            proc->isFinished = true;
-            proc->finishedTime = generateTimestamp();
-        }
-        else {
-            // Core idle this cycle
-            idleCpuTicks++;
-            this_thread::sleep_for(chrono::milliseconds(GLOBAL_CONFIG.delayPerExec));
-        }
+// Saturating parse of a decimal literal into the uint16 value range
+uint16_t parseUint16(const string& digits) {
+    uint32_t value = 0;
+    for (char c : digits) {
+        value = value * 10 + static_cast<uint32_t>(c - '0');
+        if (value > 65535) return 65535;
     }
+    return static_cast<uint16_t>(value);
 }
 
-bool validateCustomInstructions(const string& raw) {
+// Parses and validates a `screen -c` program, decoding every instruction into
+// an opcode with resolved operand slots. Returns false if any is malformed.
+bool compileCustomInstructions(const string& raw, vector<Instruction>& program,
+    SymbolTable& vars) {
     // Split on ‘;’
     istringstream splitter(raw);
     string instr;
     // pre-compile all your allowed patterns:
-    static const vector<regex> patterns = {
-        regex(R"(^DECLARE\s+[A-Za-z_]\w*\s+\d+$)"),
-        regex(R"(^ADD\s+[A-Za-z_]\w*\s+[A-Za-z_]\w*\s+[A-Za-z_]\w*$)"),
-        regex(R"(^SUBTRACT\s+[A-Za-z_]\w*\s+[A-Za-z_]\w*\s+[A-Za-z_]\w*$)"),
-        regex(R"(^PRINT\(\s*"Result: "\s*\+\s*[A-Za-z_]\w*\s*\)$)"),
-        regex(R"(^WRITE\s+0x[0-9A-Fa-f]+\s+(?:\d+|[A-Za-z_]\w*)$)"),
-        regex(R"(^READ\s+[A-Za-z_]\w*\s+0x[0-9A-Fa-f]+$)")
-    };
+    static const regex declareRe(R"(^DECLARE\s+([A-Za-z_]\w*)\s+(\d+)$)");
+    static const regex addRe(R"(^ADD\s+([A-Za-z_]\w*)\s+([A-Za-z_]\w*)\s+([A-Za-z_]\w*)$)");
+    static const regex subRe(R"(^SUBTRACT\s+([A-Za-z_]\w*)\s+([A-Za-z_]\w*)\s+([A-Za-z_]\w*)$)");
+    static const regex printRe(R"(^PRINT\(\s*"Result: "\s*\+\s*([A-Za-z_]\w*)\s*\)$)");
+    static const regex writeRe(R"(^WRITE\s+0x([0-9A-Fa-f]+)\s+(\d+|[A-Za-z_]\w*)$)");
+    static const regex readRe(R"(^READ\s+([A-Za-z_]\w*)\s+0x([0-9A-Fa-f]+)$)");
+
+    program.clear();
+    vars = SymbolTable();
 
     while (getline(splitter, instr, ';')) {
         // trim leading/trailing whitespace
@@ -1099,11 +3596,44 @@ bool validateCustomInstructions(const string& raw) {
         if (start == string::npos) continue;              // skip empty
         size_t end = instr.find_last_not_of(" \t");
         string t = instr.substr(start, end - start + 1);
-        bool ok = false;
-        for (auto& re : patterns) {
-            if (regex_match(t, re)) { ok = true; break; }
+
+        smatch m;
+        Instruction ins;
+        if (regex_match(t, m, declareRe)) {
+            ins.op = OpCode::DECLARE;
+            ins.dst = vars.intern(m[1]);
+            ins.imm = parseUint16(m[2]);
+        }
+        else if (regex_match(t, m, addRe) || regex_match(t, m, subRe)) {
+            ins.op = t[0] == 'A' ? OpCode::ADD : OpCode::SUBTRACT;
+            ins.dst = vars.intern(m[1]);
+            ins.a = vars.intern(m[2]);
+            ins.b = vars.intern(m[3]);
+        }
+        else if (regex_match(t, m, printRe)) {
+            ins.op = OpCode::PRINT;
+            ins.a = vars.intern(m[1]);
+        }
+        else if (regex_match(t, m, writeRe)) {
+            string hexDigits = m[1];
+            string tok = m[2];
+            // Oversized addresses saturate so the bounds check rejects them
+            ins.op = OpCode::WRITE;
+            ins.address = hexDigits.size() > 16 ? UINT64_MAX : stoull(hexDigits, nullptr, 16);
+            ins.srcIsImm = isdigit(static_cast<unsigned char>(tok[0])) != 0;
+            if (ins.srcIsImm) ins.imm = parseUint16(tok);
+            else ins.b = vars.intern(tok);
+        }
+        else if (regex_match(t, m, readRe)) {
+            string hexDigits = m[2];
+            ins.op = OpCode::READ;
+            ins.dst = vars.intern(m[1]);
+            ins.address = hexDigits.size() > 16 ? UINT64_MAX : stoull(hexDigits, nullptr, 16);
+        }
+        else {
+            return false;
         }
-        if (!ok) return false;
+        program.push_back(ins);
     }
     return true;
 }
@@ -1134,7 +3664,9 @@ void handleScreenCommand(const string& command, ProcessManager& manager) {
             raw = raw.substr(1, raw.size() - 2);
         }
 
-        if (!validateCustomInstructions(raw)) {
+        vector<Instruction> program;
+        SymbolTable vars;
+        if (!compileCustomInstructions(raw, program, vars)) {
             cout << "Error: one or more instructions are malformed.\n"
                 << "Allowed forms:\n"
                 << "  DECLARE <var> <value>\n"
@@ -1165,8 +3697,7 @@ void handleScreenCommand(const string& command, ProcessManager& manager) {
         }
 
         // Create the process
-        manager.createProcess(processName);
-        Process* proc = manager.retrieveProcess(processName);
+        shared_ptr<Process> proc = manager.createProcess(processName);
         if (!proc) {
             cout << "Failed to create process " << processName << ".\n";
             return;
@@ -1177,33 +3708,14 @@ void handleScreenCommand(const string& command, ProcessManager& manager) {
         proc->pageTable.clear();
         proc->pageTable.resize(requestedMem / GLOBAL_CONFIG.memPerFrame);
 
-        // Store the custom instructions
-        //proc->customInstructions = raw;
-        // split on ‘;’ and trim whitespace
-        istringstream split(raw);
-        string piece;
-        while (getline(split, piece, ';')) {
-            // trim
-            size_t a = piece.find_first_not_of(" \t");
-            size_t b = piece.find_last_not_of(" \t");
-            if (a != string::npos) {
-                proc->customInstrList.push_back(piece.substr(a, b - a + 1));
-            }
-        }
+        // Attach the compiled program
+        proc->program = move(program);
+        proc->vars = move(vars);
 
         // Enqueue and display
-        {
-            lock_guard<mutex> lock(queueMutex);
-            if (GLOBAL_CONFIG.scheduler == "fcfs") {
-                fcfsQueue.push(proc);
-            }
-            else {
-                rrQueue.push(proc);
-            }
-        }
+        scheduler->enqueue(proc.get());
         displayProcess(*proc);
         printHeader();
-        cv.notify_one();
     }
     else if (option == "-ls") {
         manager.listProcesses();
@@ -1231,8 +3743,7 @@ void handleScreenCommand(const string& command, ProcessManager& manager) {
         }
 
         // Create with the normal random size first
-        manager.createProcess(processName);
-        Process* proc = manager.retrieveProcess(processName);
+        shared_ptr<Process> proc = manager.createProcess(processName);
         if (!proc) {
             cout << "Failed to create process " << processName << ".\n";
             return;
@@ -1247,25 +3758,20 @@ void handleScreenCommand(const string& command, ProcessManager& manager) {
         }
 
         // Enqueue & display
-        {
-            lock_guard<mutex> lock(queueMutex);
-            if (GLOBAL_CONFIG.scheduler == "fcfs") {
-                fcfsQueue.push(proc);
-            }
-            else {
-                rrQueue.push(proc);
-            }
-        }
+        scheduler->enqueue(proc.get());
         displayProcess(*proc);
         printHeader();
-        cv.notify_one();
     }
     else if (option == "-r" && !processName.empty()) {
-        Process* proc = manager.retrieveProcess(processName);
+        shared_ptr<Process> proc = manager.retrieveProcess(processName);
+        ProcessSummary retired;
         if (proc) {
             displayProcess(*proc);
             printHeader();
         }
+        else if (manager.retrieveRetired(processName, retired)) {
+            printRetiredProcess(retired);
+        }
         else {
             cout << "Process " << processName << " not found." << endl;
         }
@@ -1275,68 +3781,210 @@ void handleScreenCommand(const string& command, ProcessManager& manager) {
     }
 }
 
-void scheduler_start(ProcessManager& manager) {
-    // Automatically create N processes and queue them for running
-    int processCountName = 1;
-    while (!stopScheduler) {
-        // Interruptible sleep/frequency
-        for (int frequency = 0; frequency < GLOBAL_CONFIG.batchProcessFreq && !stopProcessCreation; ++frequency) {
-            this_thread::sleep_for(chrono::milliseconds(100));
-        }
-        if (stopProcessCreation) break;
-
-        while (!stopProcessCreation) {
-            string procName = "process" + (processCountName < 10 ? "0" + to_string(processCountName) : to_string(processCountName));
-
-            if (manager.retrieveProcess(procName) == nullptr) {
-                manager.createProcess(procName);
-                Process* proc = manager.retrieveProcess(procName);
-                if (proc) {
-                    lock_guard<mutex> lock(queueMutex);
-                    if (GLOBAL_CONFIG.scheduler == "fcfs") {
-                        fcfsQueue.push(proc);
-                    }
-                    else if (GLOBAL_CONFIG.scheduler == "rr") {
-                        rrQueue.push(proc);
-                    }
+// Batch process generator. Each arrival creates `batch-size` processes and
+// queues them with one bulk enqueue. Arrivals average one per
+// batch-process-freq x 100 ms (at least 100 ms) with gaps drawn from
+// `arrival-dist`: fixed, exponential (poisson) or bursty, where bursts of
+// 1-7 back-to-back arrivals are followed by a proportionally longer pause.
+class BatchGenerator {
+public:
+    // Begins a run of arrivals on the active clock; pair with stop()
+    void start() {
+        lock_guard<mutex> lock(runMutex);
+        running = true;
+        startNs = clockService.monotonicNs();
+        stopNs = startNs;
+        nextDueNs = startNs;
+        burstLeft = 0;
+        created = 0;
+        batches = 0;
+        scheduleNext();
+    }
+
+    void stop() {
+        {
+            lock_guard<mutex> lock(runMutex);
+            if (!running) return;
+            running = false;
+            stopNs = clockService.monotonicNs();
+        }
+        runCv.notify_all();
+    }
+
+    // Virtual cycle of the next arrival
+    uint64_t dueCycle() const {
+        return static_cast<uint64_t>((nextDueNs + 999999) / 1000000);
+    }
+
+    // Creates and queues one batch, then schedules the next arrival
+    void arrive(ProcessManager& manager) {
+        vector<Process*> procs = manager.createBatch(GLOBAL_CONFIG.batchSize, nameCounter);
+        scheduler->enqueueBatch(procs);
+        created += procs.size();
+        ++batches;
+        scheduleNext();
+    }
+
+    // Real-time batch thread: sleeps until each arrival is due. Deadlines are
+    // absolute, so time spent creating a batch does not lower the rate.
+    void run(ProcessManager& manager) {
+        while (true) {
+            {
+                unique_lock<mutex> lock(runMutex);
+                int64_t waitNs = nextDueNs - clockService.monotonicNs();
+                if (waitNs > 0) {
+                    runCv.wait_for(lock, chrono::nanoseconds(waitNs),
+                        [this] { return !running || clockService.monotonicNs() >= nextDueNs; });
                 }
-                cv.notify_one();
-                ++processCountName;
-                break;
+                if (!running) return;
+            }
+            arrive(manager);
+        }
+    }
+
+    void printStats() const {
+        double seconds = static_cast<double>(stopNs - startNs) / 1e9;
+        double target = static_cast<double>(GLOBAL_CONFIG.batchSize) * 1e9 / meanGapNs();
+        cout << "Batch generator (" << GLOBAL_CONFIG.arrivalDist << "): "
+            << created << " processes in " << batches << " batches over "
+            << fixed << setprecision(3) << seconds << " s, "
+            << setprecision(1) << (seconds > 0 ? created / seconds : 0.0)
+            << " processes/s achieved (target " << target << "/s)\n";
+    }
+
+private:
+    static double meanGapNs() {
+        return static_cast<double>(max<uint64_t>(GLOBAL_CONFIG.batchProcessFreq, 1)) * 100 * 1e6;
+    }
+
+    void scheduleNext() {
+        Xoshiro256& rng = rngService.arrivals();
+        double gap = meanGapNs();
+        if (GLOBAL_CONFIG.arrivalDist == "poisson") {
+            // Uniform in (0, 1] from the top 53 bits, then inverse CDF
+            double u = (static_cast<double>(rng.next() >> 11) + 1.0) / 9007199254740992.0;
+            gap *= -log(u);
+        }
+        else if (GLOBAL_CONFIG.arrivalDist == "bursty") {
+            if (burstLeft > 0) {
+                --burstLeft;
+                gap = 0;
             }
             else {
-                ++processCountName;
+                uint64_t burst = rng.between(1, 7);
+                burstLeft = burst - 1;
+                gap *= static_cast<double>(burst);
+            }
+        }
+        nextDueNs += static_cast<int64_t>(gap);
+    }
+
+    mutex runMutex;
+    condition_variable runCv;
+    bool running = false;
+    int64_t startNs = 0;
+    int64_t stopNs = 0;
+    int64_t nextDueNs = 0;
+    uint64_t burstLeft = 0;
+    uint64_t nameCounter = 1;   // processNN numbering carries over restarts
+    uint64_t created = 0;
+    uint64_t batches = 0;
+};
+
+BatchGenerator batchGenerator;
+
+void scheduler_start(ProcessManager& manager) {
+    batchGenerator.run(manager);
+}
+
+// --virtual-time: starts every core with a step event at the current cycle,
+// the equivalent of launching the cpuWorker threads
+void startVirtualCores() {
+    for (int i = 1; i <= GLOBAL_CONFIG.numCPU; ++i) {
+        simulator.post(simulator.now(), EventSimulator::Kind::CoreStep, i);
+    }
+}
+
+// --virtual-time: processes events up to `untilCycle`, or until no core has
+// work left when `untilIdle` is set. Returns the number of events handled.
+uint64_t runVirtualTime(ProcessManager& manager, uint64_t untilCycle, bool untilIdle) {
+    // An instruction occupies its core for one tick of delay-per-exec
+    uint64_t stepCycles = max<uint64_t>(GLOBAL_CONFIG.delayPerExec, 1);
+    uint64_t handled = 0;
+    EventSimulator::Event event;
+
+    while (simulator.next(untilCycle, event)) {
+        ++handled;
+        utilSampler.catchUp(static_cast<int64_t>(event.cycle) * 1000000);
+        if (event.kind == EventSimulator::Kind::BatchArrival) {
+            // Everything due by this cycle arrives now (bursts share a cycle)
+            while (batchGenerator.dueCycle() <= event.cycle) {
+                batchGenerator.arrive(manager);
             }
+            simulator.post(batchGenerator.dueCycle(), EventSimulator::Kind::BatchArrival);
+            continue;
         }
+
+        if (coreStep(event.coreId)) {
+            uint64_t cost = stepCycles + simulator.takeStall();
+            bumpCounter(coreStates[event.coreId - 1].busyNs, cost * 1000000);
+            simulator.post(event.cycle + cost, EventSimulator::Kind::CoreStep, event.coreId);
+        }
+        else {
+            parkCore(event.coreId);
+        }
+
+        if (untilIdle && simulator.empty()) break;
     }
+
+    if (!untilIdle) simulator.advanceTo(untilCycle);
+    utilSampler.catchUp(clockService.monotonicNs());
+    return handled;
 }
 
 void printPhysicalMemory() {
-    std::lock_guard<std::mutex> lock(memMutex);
     cout << "\n[Physical Memory State]\n";
     for (size_t i = 0; i < physicalMemory.size(); ++i) {
         const Frame& f = physicalMemory[i];
         cout << "Frame " << i << ": ";
-        if (f.processId == -1) {
+
+        // The owner is read, resolved and try-locked under replMutex. An
+        // owner still recorded on a frame then has not released its frames,
+        // so it cannot have been retired and freed.
+        ProcessHandle handle = NO_PROCESS;
+        Process* owner = nullptr;
+        {
+            std::lock_guard<std::mutex> replLock(replMutex);
+            handle = f.owner;
+            owner = processTable.get(handle);
+            if (owner && !owner->ptMutex.try_lock()) {
+                cout << "(changing)\n";
+                continue;
+            }
+        }
+        if (!owner) {
             cout << "FREE\n";
+            continue;
         }
-        else {
-            cout << "PID=" << f.processId << ", Page=" << f.pageNumber
-                << ", Data=\"" << f.data << "\"\n";
+
+        // The owner's page-table lock pins the frame while its bytes are read
+        std::lock_guard<std::mutex> lock(owner->ptMutex, std::adopt_lock);
+        int page = f.pageNumber;
+        if (f.owner != handle || page < 0
+            || owner->pageTable[page].frameIndex != static_cast<int>(i)) {
+            cout << "(changing)\n";
+            continue;
         }
+        uint64_t base = static_cast<uint64_t>(page) * GLOBAL_CONFIG.memPerFrame;
+        cout << "PID=" << owner->id << ", Page=" << page
+            << ", Data=\"" << formatPageBytes(frameData(static_cast<int>(i)), base) << "\"\n";
     }
     cout << "-----------------------------\n";
 }
 
 void printMemorySummary() {
     uint64_t totalMemory = GLOBAL_CONFIG.maxOverallMem;
-    uint64_t usedMemory = 0;
-
-    for (const auto& frame : physicalMemory) {
-        if (frame.processId != -1) {
-            usedMemory += GLOBAL_CONFIG.memPerFrame;
-        }
-    }
+    uint64_t usedMemory = frameAllocator.used() * GLOBAL_CONFIG.memPerFrame;
 
     uint64_t freeMemory = totalMemory > usedMemory ? totalMemory - usedMemory : 0;
 
@@ -1346,24 +3994,122 @@ void printMemorySummary() {
     cout << "Free  memory     : " << freeMemory << " bytes\n";
 
     cout << "\n[CPU Tick Summary]\n";
-    cout << "Active CPU ticks : " << activeCpuTicks.load() << endl;
-    cout << "Idle   CPU ticks : " << idleCpuTicks.load() << endl;
-    cout << "Total  CPU ticks : " << totalCpuTicks.load() << endl;
+    // Summed from the per-core counters; parked cores are charged when they
+    // wake, so include what they owe so far
+    uint64_t busyNs = 0;
+    uint64_t idleNs = 0;
+    for (size_t i = 0; i < coreStates.size(); ++i) {
+        busyNs += coreStates[i].busyNs.load();
+        idleNs += coreStates[i].idleNs.load() + pendingIdleNs(static_cast<int>(i) + 1);
+    }
+    uint64_t tickNs = static_cast<uint64_t>(idleTickPeriod().count());
+    cout << "Active CPU ticks : " << busyNs / tickNs << endl;
+    cout << "Idle   CPU ticks : " << idleNs / tickNs << endl;
+    cout << "Total  CPU ticks : " << (busyNs + idleNs) / tickNs << endl;
 
     cout << "\n[Paging Summary]\n";
     cout << "Num paged in     : " << pageInCount.load() << endl;
     cout << "Num paged out    : " << pageOutCount.load() << endl;
 
+    cout << "\n[Write-back Summary]\n";
+    writeback.printStats();
+
+    cout << "-----------------------------\n";
+}
+
+// Contention benchmark for the memory subsystem. For 1, 2, 4 ... 128 threads,
+// each thread drives its own synthetic process through random word reads and
+// writes for a fixed interval. Resident hits only take the process' own lock,
+// so throughput should keep scaling until faults start to dominate.
+void runMemoryBenchmark() {
+    static constexpr auto BENCH_INTERVAL = chrono::milliseconds(200);
+
+    uint64_t memSize = max(GLOBAL_CONFIG.minMemPerProc, GLOBAL_CONFIG.memPerFrame);
+
+    cout << "\n[Memory Contention Benchmark]\n";
+    cout << "Per-thread process: " << memSize << " bytes, "
+        << memSize / GLOBAL_CONFIG.memPerFrame << " pages, 90% reads\n";
+    cout << "Threads  Ops/sec         Speedup  Page faults\n";
+
+    double baseline = 0.0;
+    for (int threads = 1; threads <= 128; threads *= 2) {
+        vector<unique_ptr<Process>> procs;
+        for (int t = 0; t < threads; ++t) {
+            auto proc = make_unique<Process>();
+            proc->name = "bench" + to_string(t);
+            proc->memorySize = memSize;
+            proc->pageTable.resize(memSize / GLOBAL_CONFIG.memPerFrame);
+            processTable.insert(proc.get());
+            procs.push_back(move(proc));
+        }
+
+        atomic<bool> go = false;
+        atomic<bool> done = false;
+        atomic<uint64_t> totalOps = 0;
+        uint64_t faultsBefore = pageInCount.load();
+
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, proc = procs[t].get(), t] {
+                mt19937 gen(t + 1);
+                uniform_int_distribution<uint64_t> addrDist(0, memSize - 1);
+                uint64_t ops = 0;
+                while (!go) this_thread::yield();
+                while (!done) {
+                    for (int i = 0; i < 64; ++i, ++ops) {
+                        uint64_t address = addrDist(gen);
+                        if (ops % 10 == 0) {
+                            writeWord(proc, address, static_cast<uint16_t>(ops));
+                        }
+                        else {
+                            uint16_t value;
+                            readWord(proc, address, value);
+                        }
+                    }
+                }
+                totalOps += ops;
+                });
+        }
+
+        auto start = chrono::steady_clock::now();
+        go = true;
+        this_thread::sleep_for(BENCH_INTERVAL);
+        done = true;
+        for (auto& w : workers) w.join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        for (auto& proc : procs) {
+            std::lock_guard<std::mutex> lock(proc->ptMutex);
+            releaseProcessFrames(proc.get());
+            writeback.discardProcess(proc->id);
+            backingStore.discardProcess(proc->id);
+            processTable.remove(proc->handle);
+        }
+
+        double opsPerSec = totalOps.load() / seconds;
+        if (threads == 1) baseline = opsPerSec;
+        cout << left << setw(9) << threads
+            << setw(16) << fixed << setprecision(0) << opsPerSec
+            << setw(9) << setprecision(2) << (baseline > 0 ? opsPerSec / baseline : 0.0)
+            << pageInCount.load() - faultsBefore << right << "\n";
+    }
     cout << "-----------------------------\n";
 }
 
 
-int main() {
-    ProcessManager manager;
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (string(argv[i]) == "--virtual-time") virtualTimeMode = true;
+    }
+
+    ProcessManager& manager = processManager;
     thread scheduler_start_thread;
     bool schedulerRunning = false;
 
     printHeader();
+    if (virtualTimeMode) {
+        cout << "Virtual-time mode: use 'run <cycles>' or 'run' to advance the simulation.\n";
+    }
 
     vector<thread> cpuThreads;
     bool confirmInitialize = false;
@@ -1374,16 +4120,69 @@ int main() {
         getline(cin, command);
 
         if (command == "initialize") {
+            // Stop old threads if already initialized. Nothing may touch the
+            // config or the memory subsystem while they are replaced below.
+            if (confirmInitialize) {
+                cout << "Reinitializing system...\n";
+                if (schedulerRunning) {
+                    batchGenerator.stop();
+                    if (scheduler_start_thread.joinable()) {
+                        scheduler_start_thread.join();
+                    }
+                    schedulerRunning = false;
+                }
+                stopScheduler = true;
+                wakeAllCores();
+                for (auto& t : cpuThreads) {
+                    if (t.joinable()) t.join();
+                }
+                cpuThreads.clear();  // Important: clear thread list
+                stopScheduler = false;
+                utilSampler.stop();
+                confirmInitialize = false;  // until the new config loads
+            }
+
             if (loadSystemConfig()) {
+                uint64_t runSeed = RngService::resolveSeed(GLOBAL_CONFIG.seed);
                 size_t numFrames = GLOBAL_CONFIG.maxOverallMem / GLOBAL_CONFIG.memPerFrame;
-                physicalMemory.assign(numFrames, Frame());
+
+                // Drain queued write-backs into the old store before it goes
+                writeback.stop();
+                physicalMemory = vector<Frame>(numFrames);
+                physicalArena.assign(numFrames * GLOBAL_CONFIG.memPerFrame, 0);
+                pageReplacer.reset(numFrames, parseReplacementPolicy(GLOBAL_CONFIG.pageReplacement));
+                frameAllocator.reset(numFrames);
+                backingStore.reset(GLOBAL_CONFIG.memPerFrame);
+                writeback.start();
+
+                // Live processes still map frames of the old arena; their
+                // pages start over, sized for the new frame size
+                processTable.forEach([](Process* proc) {
+                    std::lock_guard<std::mutex> lock(proc->ptMutex);
+                    if (proc->isFinished) return;
+                    proc->pageTable.assign(proc->memorySize / GLOBAL_CONFIG.memPerFrame, PageTableEntry());
+                    proc->residentPages = 0;
+                });
 
                 cout << "\n System configuration loaded successfully:\n";
                 cout << "--------------------------------------------\n";
                 cout << "- num-cpu:            " << GLOBAL_CONFIG.numCPU << "\n";
                 cout << "- scheduler:          " << GLOBAL_CONFIG.scheduler << "\n";
                 cout << "- quantum-cycles:     " << GLOBAL_CONFIG.quantumCycles << "\n";
+                if (GLOBAL_CONFIG.scheduler == "mlfq") {
+                    cout << "- mlfq-levels:        " << GLOBAL_CONFIG.mlfqLevels << "\n";
+                    cout << "- mlfq-boost-ms:      " << GLOBAL_CONFIG.mlfqBoostMs << "\n";
+                }
+                if (GLOBAL_CONFIG.scheduler == "sjf" || GLOBAL_CONFIG.scheduler == "srtf") {
+                    cout << "- aging-ms:           " << GLOBAL_CONFIG.agingMs << "\n";
+                }
                 cout << "- batch-process-freq: " << GLOBAL_CONFIG.batchProcessFreq << "\n";
+                cout << "- migration-threshold:" << GLOBAL_CONFIG.migrationThreshold << "\n";
+                cout << "- migration-penalty:  " << GLOBAL_CONFIG.migrationPenalty << "\n";
+                cout << "- util-sample-ms:     " << GLOBAL_CONFIG.utilSampleMs << "\n";
+                cout << "- util-history:       " << GLOBAL_CONFIG.utilHistory << "\n";
+                cout << "- batch-size:         " << GLOBAL_CONFIG.batchSize << "\n";
+                cout << "- arrival-dist:       " << GLOBAL_CONFIG.arrivalDist << "\n";
                 cout << "- min-ins:            " << GLOBAL_CONFIG.minInstructions << "\n";
                 cout << "- max-ins:            " << GLOBAL_CONFIG.maxInstructions << "\n";
                 cout << "- delay-per-exec:     " << GLOBAL_CONFIG.delayPerExec << "\n";
@@ -1391,28 +4190,36 @@ int main() {
                 cout << "- mem-per-frame:      " << GLOBAL_CONFIG.memPerFrame << "\n";
                 cout << "- min-mem-per-proc:   " << GLOBAL_CONFIG.minMemPerProc << "\n";
                 cout << "- max-mem-per-proc:   " << GLOBAL_CONFIG.maxMemPerProc << "\n";
+                cout << "- page-replacement:   " << GLOBAL_CONFIG.pageReplacement << "\n";
+                cout << "- seed:               " << runSeed << "\n";
+                cout << "- log-capacity:       " << GLOBAL_CONFIG.logCapacity << "\n";
+                cout << "- log-spill:          " << (GLOBAL_CONFIG.logSpill ? "on" : "off") << "\n";
+                if (GLOBAL_CONFIG.logSpill) {
+                    error_code ec;
+                    filesystem::create_directories(LOG_SEGMENT_DIR, ec);
+                }
                 cout << "Initialized physical memory with " << numFrames << " frames.\n";
                 cout << "--------------------------------------------\n";
 
                 printPhysicalMemory();
 
-                // Stop old threads if already initialized
-                if (confirmInitialize) {
-                    cout << "Reinitializing system...\n";
-                    stopScheduler = true;
-                    stopProcessCreation = true;
-                    cv.notify_all();
-                    for (auto& t : cpuThreads) {
-                        if (t.joinable()) t.join();
-                    }
-                    cpuThreads.clear();  // Important: clear thread list
-                    stopScheduler = false;
-                    stopProcessCreation = false;
-                }
-
                 // Start new CPU threads based on updated config
-                for (int i = 0; i < GLOBAL_CONFIG.numCPU; ++i) {
-                    cpuThreads.emplace_back(cpuWorker, i + 1);
+                latencyStats.reset();
+                rngService.reset(runSeed, GLOBAL_CONFIG.numCPU);
+                if (virtualTimeMode) {
+                    simulator.reset();
+                    schedulerRunning = false;
+                    resetScheduler(GLOBAL_CONFIG.numCPU);
+                    utilSampler.reset(GLOBAL_CONFIG.numCPU);
+                    startVirtualCores();
+                }
+                else {
+                    resetScheduler(GLOBAL_CONFIG.numCPU);
+                    utilSampler.reset(GLOBAL_CONFIG.numCPU);
+                    utilSampler.start();
+                    for (int i = 0; i < GLOBAL_CONFIG.numCPU; ++i) {
+                        cpuThreads.emplace_back(cpuWorker, i + 1);
+                    }
                 }
 
                 confirmInitialize = true;
@@ -1446,9 +4253,16 @@ int main() {
                 cout << "Please initialize first.\n";
                 continue;
             }
-            if (!schedulerRunning) {
-                stopProcessCreation = false;
+            if (!schedulerRunning && virtualTimeMode) {
+                schedulerRunning = true;
+                simulator.startBatches();
+                batchGenerator.start();
+                simulator.post(batchGenerator.dueCycle(), EventSimulator::Kind::BatchArrival);
+                cout << "Scheduler is running!\n";
+            }
+            else if (!schedulerRunning) {
                 schedulerRunning = true;
+                batchGenerator.start();
                 scheduler_start_thread = thread(scheduler_start, ref(manager));
                 cout << "Scheduler is running!\n";
             }
@@ -1466,16 +4280,55 @@ int main() {
                 scheduler_start_thread.join();
                 stopScheduler = false;*/
 
-                stopProcessCreation = true;
                 schedulerRunning = false;
+                simulator.stopBatches();
+                batchGenerator.stop();
                 if (scheduler_start_thread.joinable()) {
                     scheduler_start_thread.join();
                 }
+                batchGenerator.printStats();
             }
             else {
                 cout << "Scheduler is not running.\n";
             }
         }
+        else if (command == "run" || command.rfind("run ", 0) == 0) {
+            if (!virtualTimeMode) {
+                cout << "run is only available with --virtual-time.\n";
+                continue;
+            }
+            if (!confirmInitialize) {
+                cout << "Please initialize first.\n";
+                continue;
+            }
+
+            string arg = command.size() > 4 ? command.substr(4) : "";
+            bool untilIdle = arg.empty();
+            uint64_t cycles = 0;
+            if (!untilIdle) {
+                try {
+                    cycles = stoull(arg);
+                }
+                catch (...) {
+                    cout << "Usage: run [cycles]\n";
+                    continue;
+                }
+            }
+            else if (schedulerRunning) {
+                cout << "Scheduler is creating processes; give a cycle count: run <cycles>\n";
+                continue;
+            }
+
+            uint64_t start = simulator.now();
+            auto wallStart = chrono::steady_clock::now();
+            uint64_t events = runVirtualTime(manager,
+                untilIdle ? numeric_limits<uint64_t>::max() : start + cycles, untilIdle);
+            double wallMs = chrono::duration<double, milli>(chrono::steady_clock::now() - wallStart).count();
+
+            cout << "Advanced " << simulator.now() - start << " cycles to cycle " << simulator.now()
+                << " (" << events << " events, " << fixed << setprecision(1) << wallMs << " ms host time)\n";
+            cout.unsetf(ios::fixed);
+        }
         else if (command == "clear") {
             clearScreen();
             printHeader();
@@ -1485,8 +4338,8 @@ int main() {
             if (schedulerRunning) {
                 cout << "Stopping scheduler...\n";
 
-                stopProcessCreation = true;
                 schedulerRunning = false;
+                batchGenerator.stop();
                 if (scheduler_start_thread.joinable()) {
                     scheduler_start_thread.join();
                 }
@@ -1499,31 +4352,53 @@ int main() {
             printPhysicalMemory();
         }
         else if (command == "backing") {
-            std::lock_guard<std::mutex> lock(memMutex);
             cout << "\n[Backing Store Contents]\n";
-            for (const auto& [key, val] : backingStore) {
-                cout << "Process " << key.first << ", Page " << key.second
-                    << " => \"" << val << "\"\n";
-            }
+            backingStore.forEachPage([](int pid, int pageNumber, const uint8_t* data) {
+                uint64_t base = static_cast<uint64_t>(pageNumber) * GLOBAL_CONFIG.memPerFrame;
+                cout << "Process " << pid << ", Page " << pageNumber
+                    << " => \"" << formatPageBytes(data, base) << "\"\n";
+                });
+            writeback.forEachPending([](int pid, int pageNumber, const uint8_t* data) {
+                uint64_t base = static_cast<uint64_t>(pageNumber) * GLOBAL_CONFIG.memPerFrame;
+                cout << "Process " << pid << ", Page " << pageNumber
+                    << " => \"" << formatPageBytes(data, base) << "\" (queued)\n";
+                });
             cout << "-----------------------------\n";
 
             printPhysicalMemory();
         }
+        else if (command == "backing-dump") {
+            dumpBackingStoreToText();
+            cout << "Backing store dumped to " << BACKING_FILENAME << "\n";
+        }
         else if (command == "process-smi") {
-            displaySystemStats(manager);
+            displaySystemStats();
+        }
+        else if (command == "latency-stats") {
+            latencyStats.print(cout);
+            cout.unsetf(ios::fixed);
         }
         else if (command == "vmstats") {
             printMemorySummary();
         }
+        else if (command == "bench-mem") {
+            if (!confirmInitialize) {
+                cout << "Please initialize first.\n";
+            }
+            else {
+                runMemoryBenchmark();
+            }
+        }
         else {
             cout << "Unknown command.\n";
         }
     }
 
     stopScheduler = true;
-    stopProcessCreation = true;
-    cv.notify_all();
+    wakeAllCores();
     for (auto& t : cpuThreads) t.join();
+    utilSampler.stop();
+    writeback.stop();
 
     return 0;
 }
\ No newline at end of file